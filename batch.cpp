@@ -0,0 +1,118 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "jobs.h"
+#include "projection.h"
+#include "scenes.h"
+#include "framewriter.h"
+
+// offline multi-view render: renders one scene of TestScene::Suite from every camera along its path
+// and streams the frames to a y4m video or a directory of ppm files
+//
+//   ./batch [--scene cubes_512] [--frames 120] [--out turntable.y4m] [--format y4m|ppm] [--fps 30]
+//           [--config supersample=2] [--threads 1] [--queue 8] [--width 400] [--height 300]
+
+int main(int argc, char* argv[])
+{
+    int canvasWidth = 400;
+    int canvasHeight = 300;
+    int frames = 120;
+    int fps = 30;
+    int threads = std::thread::hardware_concurrency();
+    int queue = 8;
+    std::string sceneName = "cubes_512";
+    std::string outPath = "turntable.y4m";
+    FrameFormat format = FRAME_Y4M;
+    RenderConfig config = RenderConfig();
+
+    try {
+        for(int i = 1;i<argc;i++)
+        {
+            std::string arg = argv[i];
+            if(i + 1 >= argc){
+                throw std::invalid_argument("Missing value for " + arg);
+            };
+            std::string value = argv[++i];
+
+            if(arg == "--config"){
+                config = RenderConfig::parse(value);
+            } else if(arg == "--threads"){
+                threads = std::max(std::stoi(value), 1);
+            } else if(arg == "--frames"){
+                frames = std::max(std::stoi(value), 1);
+            } else if(arg == "--fps"){
+                fps = std::stoi(value);
+            } else if(arg == "--queue"){
+                queue = std::max(std::stoi(value), 1);
+            } else if(arg == "--width"){
+                canvasWidth = std::stoi(value);
+            } else if(arg == "--height"){
+                canvasHeight = std::stoi(value);
+            } else if(arg == "--scene"){
+                sceneName = value;
+            } else if(arg == "--out"){
+                outPath = value;
+            } else if(arg == "--format"){
+                if(value == "y4m"){
+                    format = FRAME_Y4M;
+                } else if(value == "ppm"){
+                    format = FRAME_PPM_SEQUENCE;
+                } else {
+                    throw std::invalid_argument("format must be y4m or ppm");
+                };
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg);
+            };
+        };
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    };
+
+    std::vector<TestScene> suite = TestScene::Suite();
+    TestScene testScene;
+    bool found = false;
+    for(int i = 0;i<suite.size();i++)
+    {
+        if(suite[i].name == sceneName){
+            testScene = suite[i];
+            found = true;
+        };
+    };
+    if(!found){
+        std::cerr << "Unknown scene " << sceneName << std::endl;
+        return 2;
+    };
+
+    std::vector<Camera> cameras;
+    cameras.reserve(frames);
+    for(int i = 0;i<frames;i++)
+    {
+        cameras.push_back(testScene.camera(i, frames));
+    };
+
+    JobSystem jobs = JobSystem(threads);
+    if(threads > 1){
+        config.jobs = &jobs;
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    FrameWriter writer = FrameWriter(outPath, format, fps, queue);
+    renderViews(cameras, canvasWidth, canvasHeight, testScene.scene, config, [&writer](int index, Frame &frame){
+        writer.push(std::move(frame));
+    });
+    try {
+        writer.close();
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    };
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Wrote " << writer.framesWritten() << " frames of " << sceneName << " to " << outPath << " in " << seconds << " s (" << writer.framesWritten() / seconds << " fps)" << std::endl;
+
+    return 0;
+};
@@ -0,0 +1,284 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+#include "jobs.h"
+#include "projection.h"
+#include "scenes.h"
+
+// headless benchmark: renders every scene of TestScene::Suite along its camera path and reports per-stage timings as json.
+// --baseline reads a json written by an earlier run and prints each stage's median and p99 change against it
+//
+//   ./bench [--config supersample=2] [--threads 1] [--frames 60] [--warmup 5] [--width 400] [--height 300] [--scene cubes_512]
+//           [--out bench.json] [--baseline baseline.json]
+
+class Samples
+{
+    public:
+        std::vector<float> values;
+
+        void add(float value)
+        {
+            this->values.push_back(value);
+        };
+
+        // nearest rank percentile
+        float percentile(float p)
+        {
+            if(this->values.empty()){
+                return 0;
+            };
+            std::vector<float> sorted = this->values;
+            std::sort(sorted.begin(), sorted.end());
+            int rank = ceil(p / 100 * sorted.size());
+            return sorted[std::max(rank, 1) - 1];
+        };
+
+        std::string toJson()
+        {
+            return "{ \"median\": " + std::to_string(this->percentile(50)) + ", \"p99\": " + std::to_string(this->percentile(99)) + " }";
+        };
+};
+
+// stage timings read back from a json this benchmark wrote
+class Baseline
+{
+    public:
+        std::string json;
+
+        Baseline()
+        {
+            this->json = "";
+        };
+
+        Baseline(std::string path)
+        {
+            std::ifstream file(path);
+            if(!file){
+                throw std::runtime_error("Could not open baseline " + path);
+            };
+            std::stringstream contents;
+            contents << file.rdbuf();
+            this->json = contents.str();
+        };
+
+        // stat is "median" or "p99", returns -1 when the baseline has no such scene or stage
+        float stage(std::string scene, std::string stage, std::string stat)
+        {
+            size_t begin = this->json.find("\"scene\": \"" + scene + "\"");
+            if(begin == std::string::npos){
+                return -1;
+            };
+            size_t end = this->json.find("\"scene\": ", begin + 1);
+            std::string result = this->json.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+            size_t stageStart = result.find("\"" + stage + "\": {");
+            if(stageStart == std::string::npos){
+                return -1;
+            };
+            size_t statStart = result.find("\"" + stat + "\": ", stageStart);
+            if(statStart == std::string::npos){
+                return -1;
+            };
+            return std::stof(result.substr(statStart + stat.size() + 4));
+        };
+};
+
+std::string compareStat(float baseline, float current)
+{
+    std::stringstream text;
+    text << std::fixed << std::setprecision(3) << baseline << " -> " << current << " ms";
+    if(baseline > 0){
+        text << " (" << std::showpos << std::setprecision(1) << 100 * (current - baseline) / baseline << "%)";
+    };
+    return text.str();
+};
+
+// prints one line per stage to stderr, stdout stays pure json
+void compareScene(std::string scene, std::vector<std::pair<std::string, Samples*>> stages, Baseline &baseline)
+{
+    if(baseline.json.find("\"scene\": \"" + scene + "\"") == std::string::npos){
+        std::cerr << "  not in baseline" << std::endl;
+        return;
+    };
+
+    for(int i = 0;i<stages.size();i++)
+    {
+        float median = baseline.stage(scene, stages[i].first, "median");
+        float p99 = baseline.stage(scene, stages[i].first, "p99");
+        if(median < 0 || p99 < 0){
+            std::cerr << "  " << stages[i].first << ": not in baseline" << std::endl;
+            continue;
+        };
+        std::cerr << "  " << stages[i].first << ": median " << compareStat(median, stages[i].second->percentile(50)) << ", p99 " << compareStat(p99, stages[i].second->percentile(99)) << std::endl;
+    };
+};
+
+std::string benchScene(TestScene &testScene, RenderConfig config, int canvasWidth, int canvasHeight, int frames, int warmup, Baseline *baseline)
+{
+    Samples buffer, transform, raster, resolve, total;
+    long trianglesIn = 0;
+    long trianglesRastered = 0;
+    long samplesTested = 0;
+    long samplesWritten = 0;
+
+    for(int i = -warmup;i<frames;i++)
+    {
+        Camera camera = testScene.camera(std::max(i, 0), frames);
+        camera.render(canvasWidth, canvasHeight, testScene.scene, config);
+
+        if(i < 0){
+            continue;
+        };
+
+        buffer.add(camera.stats.bufferTime);
+        transform.add(camera.stats.transformTime);
+        raster.add(camera.stats.rasterTime);
+        resolve.add(camera.stats.resolveTime);
+        total.add(camera.stats.totalTime);
+        trianglesIn += camera.stats.trianglesIn;
+        trianglesRastered += camera.stats.trianglesRastered;
+        samplesTested += camera.stats.samplesTested;
+        samplesWritten += camera.stats.samplesWritten;
+    };
+
+    if(baseline){
+        compareScene(testScene.name, { { "buffer", &buffer }, { "transform", &transform }, { "raster", &raster }, { "resolve", &resolve }, { "total", &total } }, *baseline);
+    };
+
+    float totalSeconds = 0;
+    float rasterSeconds = 0;
+    for(int i = 0;i<frames;i++)
+    {
+        totalSeconds += total.values[i] / 1000;
+        rasterSeconds += raster.values[i] / 1000;
+    };
+
+    std::stringstream json;
+    json << "    {" << std::endl;
+    json << "      \"scene\": \"" << testScene.name << "\"," << std::endl;
+    json << "      \"path\": \"" << testScene.path << "\"," << std::endl;
+    json << "      \"frames\": " << frames << "," << std::endl;
+    json << "      \"triangles_per_frame\": " << trianglesIn / frames << "," << std::endl;
+    json << "      \"rastered_per_frame\": " << trianglesRastered / frames << "," << std::endl;
+    json << "      \"samples_per_frame\": " << samplesTested / frames << "," << std::endl;
+    json << "      \"written_per_frame\": " << samplesWritten / frames << "," << std::endl;
+    json << "      \"stages_ms\": {" << std::endl;
+    json << "        \"buffer\": " << buffer.toJson() << "," << std::endl;
+    json << "        \"transform\": " << transform.toJson() << "," << std::endl;
+    json << "        \"raster\": " << raster.toJson() << "," << std::endl;
+    json << "        \"resolve\": " << resolve.toJson() << "," << std::endl;
+    json << "        \"total\": " << total.toJson() << std::endl;
+    json << "      }," << std::endl;
+    // triangles submitted per second of whole render time, depth tested supersamples per second of raster time
+    json << "      \"triangles_per_sec\": " << std::to_string(totalSeconds > 0 ? trianglesIn / totalSeconds : 0) << "," << std::endl;
+    json << "      \"pixels_per_sec\": " << std::to_string(rasterSeconds > 0 ? samplesTested / rasterSeconds : 0) << std::endl;
+    json << "    }";
+
+    return json.str();
+};
+
+int main(int argc, char* argv[])
+{
+    int canvasWidth = 400;
+    int canvasHeight = 300;
+    int frames = 60;
+    int warmup = 5;
+    std::string sceneFilter = "";
+    int threads = 1;
+    std::string outPath = "";
+    std::string baselinePath = "";
+    RenderConfig config = RenderConfig();
+
+    try {
+        for(int i = 1;i<argc;i++)
+        {
+            std::string arg = argv[i];
+            if(i + 1 >= argc){
+                throw std::invalid_argument("Missing value for " + arg);
+            };
+            std::string value = argv[++i];
+
+            if(arg == "--config"){
+                config = RenderConfig::parse(value);
+            } else if(arg == "--threads"){
+                threads = std::max(std::stoi(value), 1);
+            } else if(arg == "--frames"){
+                frames = std::max(std::stoi(value), 1);
+            } else if(arg == "--warmup"){
+                warmup = std::max(std::stoi(value), 0);
+            } else if(arg == "--width"){
+                canvasWidth = std::stoi(value);
+            } else if(arg == "--height"){
+                canvasHeight = std::stoi(value);
+            } else if(arg == "--scene"){
+                sceneFilter = value;
+            } else if(arg == "--out"){
+                outPath = value;
+            } else if(arg == "--baseline"){
+                baselinePath = value;
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg);
+            };
+        };
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    };
+
+    Baseline baseline;
+    if(baselinePath != ""){
+        try {
+            baseline = Baseline(baselinePath);
+        } catch(std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        };
+    };
+
+    JobSystem jobs = JobSystem(threads);
+    if(threads > 1){
+        config.jobs = &jobs;
+    };
+
+    std::vector<TestScene> suite = TestScene::Suite();
+
+    std::stringstream json;
+    json << "{" << std::endl;
+    json << "  \"config\": \"" << config.toString() << "\"," << std::endl;
+    json << "  \"threads\": " << threads << "," << std::endl;
+    json << "  \"width\": " << canvasWidth << "," << std::endl;
+    json << "  \"height\": " << canvasHeight << "," << std::endl;
+    json << "  \"results\": [" << std::endl;
+
+    bool first = true;
+    for(int i = 0;i<suite.size();i++)
+    {
+        if(sceneFilter != "" && suite[i].name != sceneFilter){
+            continue;
+        };
+        std::cerr << "Benchmarking " << suite[i].name << std::endl;
+
+        if(!first){
+            json << "," << std::endl;
+        };
+        first = false;
+        json << benchScene(suite[i], config, canvasWidth, canvasHeight, frames, warmup, baselinePath != "" ? &baseline : nullptr);
+    };
+
+    json << std::endl << "  ]" << std::endl << "}" << std::endl;
+
+    if(outPath != ""){
+        std::ofstream out(outPath);
+        out << json.str();
+    } else {
+        std::cout << json.str();
+    };
+
+    return 0;
+};
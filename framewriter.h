@@ -0,0 +1,214 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+
+#include "projection.h"
+
+enum FrameFormat
+{
+    // one yuv4mpeg2 stream, 4:2:0 full range BT.601, tagged XCOLORRANGE=FULL since readers assume limited range
+    FRAME_Y4M,
+    // numbered binary ppm files in a directory
+    FRAME_PPM_SEQUENCE
+};
+
+// streams frames to disk from a background thread through a bounded queue, so rendering only waits
+// on disk once capacity frames are backed up. the first write error stops writing and is thrown by close
+class FrameWriter
+{
+    public:
+        FrameWriter(std::string path, FrameFormat format, int fps, int capacity)
+        {
+            this->path = path;
+            this->format = format;
+            this->fps = fps > 0 ? fps : 30;
+            this->capacity = capacity > 0 ? capacity : 1;
+            this->written = 0;
+            this->closed = false;
+
+            if(format == FRAME_Y4M){
+                this->file.open(path, std::ios::binary);
+                if(!this->file){
+                    throw std::runtime_error("Could not open " + path);
+                };
+            } else {
+                std::filesystem::create_directories(path);
+            };
+
+            this->writer = std::thread(&FrameWriter::writeLoop, this);
+        };
+
+        ~FrameWriter()
+        {
+            // an error nobody closed the writer to check for has nowhere to go from a destructor
+            try {
+                this->close();
+            } catch(...) {
+            };
+        };
+
+        // blocks while the queue is full. pass frames with std::move, only their color is queued
+        void push(Frame frame)
+        {
+            frame.depth = {};
+
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->notFull.wait(lock, [this](){
+                return this->queue.size() < this->capacity;
+            });
+            this->queue.push_back(std::move(frame));
+            this->notEmpty.notify_one();
+        };
+
+        // writes out everything still queued and stops the writer thread, throws the first write error
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if(this->closed){
+                    return;
+                };
+                this->closed = true;
+            };
+            this->notEmpty.notify_one();
+            this->writer.join();
+            if(this->file.is_open()){
+                this->file.close();
+                if(this->file.fail() && this->error == ""){
+                    this->error = "Could not write " + this->path;
+                };
+            };
+            if(this->error != ""){
+                throw std::runtime_error(this->error);
+            };
+        };
+
+        int framesWritten()
+        {
+            return this->written;
+        };
+
+    private:
+        std::string path;
+        FrameFormat format;
+        int fps;
+        int capacity;
+        std::atomic<int> written;
+        bool closed;
+        // first write error, only touched by the writer thread until it is joined
+        std::string error;
+
+        std::ofstream file;
+        std::thread writer;
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::deque<Frame> queue;
+
+        void writeLoop()
+        {
+            while(true)
+            {
+                Frame frame;
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->notEmpty.wait(lock, [this](){
+                        return this->closed || !this->queue.empty();
+                    });
+                    if(this->queue.empty()){
+                        return;
+                    };
+                    frame = std::move(this->queue.front());
+                    this->queue.pop_front();
+                };
+                this->notFull.notify_one();
+
+                // after an error frames are still taken off the queue so push never blocks for good
+                if(this->error != ""){
+                    continue;
+                };
+
+                if(this->format == FRAME_Y4M){
+                    this->writeY4M(frame);
+                    if(!this->file.good()){
+                        this->error = "Could not write frame " + std::to_string(this->written) + " to " + this->path;
+                        continue;
+                    };
+                } else {
+                    char name[32];
+                    snprintf(name, sizeof(name), "/frame_%05d.ppm", int(this->written));
+                    if(!frame.savePPM(this->path + name)){
+                        this->error = "Could not write " + this->path + name;
+                        continue;
+                    };
+                };
+                this->written++;
+            };
+        };
+
+        void writeY4M(Frame &frame)
+        {
+            if(this->written == 0){
+                this->file << "YUV4MPEG2 W" << frame.width << " H" << frame.height << " F" << this->fps << ":1 Ip A1:1 C420jpeg XYSCSS=420JPEG XCOLORRANGE=FULL\n";
+            };
+
+            int chromaWidth = (frame.width + 1) / 2;
+            int chromaHeight = (frame.height + 1) / 2;
+            std::vector<unsigned char> y(frame.width * frame.height);
+            std::vector<unsigned char> u(chromaWidth * chromaHeight);
+            std::vector<unsigned char> v(chromaWidth * chromaHeight);
+
+            for(int i = 0;i<frame.width * frame.height;i++)
+            {
+                float r = frame.rgb[3 * i];
+                float g = frame.rgb[3 * i + 1];
+                float b = frame.rgb[3 * i + 2];
+                y[i] = fmin(fmax(0.299 * r + 0.587 * g + 0.114 * b + 0.5, 0), 255);
+            };
+
+            // chroma from the average color of each 2x2 block
+            for(int cy = 0;cy<chromaHeight;cy++)
+            {
+                for(int cx = 0;cx<chromaWidth;cx++)
+                {
+                    float r = 0;
+                    float g = 0;
+                    float b = 0;
+                    int count = 0;
+                    for(int j = 2 * cy;j<2 * cy + 2 && j<frame.height;j++)
+                    {
+                        for(int i = 2 * cx;i<2 * cx + 2 && i<frame.width;i++)
+                        {
+                            int index = 3 * (j * frame.width + i);
+                            r += frame.rgb[index];
+                            g += frame.rgb[index + 1];
+                            b += frame.rgb[index + 2];
+                            count++;
+                        };
+                    };
+                    r /= count;
+                    g /= count;
+                    b /= count;
+
+                    u[cy * chromaWidth + cx] = fmin(fmax(-0.168736 * r - 0.331264 * g + 0.5 * b + 128.5, 0), 255);
+                    v[cy * chromaWidth + cx] = fmin(fmax(0.5 * r - 0.418688 * g - 0.081312 * b + 128.5, 0), 255);
+                };
+            };
+
+            this->file << "FRAME\n";
+            this->file.write((char*) y.data(), y.size());
+            this->file.write((char*) u.data(), u.size());
+            this->file.write((char*) v.data(), v.size());
+        };
+};
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <filesystem>
+
+#include "jobs.h"
+#include "projection.h"
+#include "scenes.h"
+
+// differential test: renders every scene of TestScene::Suite through a reference and a candidate RenderConfig
+// and compares the resolved frames pixel by pixel, writing ppm diff images for every failing frame.
+// the candidate defaults to the default RenderConfig and the reference to the same pipeline with the scalar
+// resolve, which has to match exactly. --reference reference compares against RenderConfig::Reference, which
+// uses a different depth format and needs looser tolerances, see the test target in the makefile.
+// --threads only applies to the candidate so the reference always runs serially
+//
+//   ./golden [--reference supersample=2] [--candidate supersample=4] [--threads 1] [--color-tolerance 0] [--depth-tolerance 0.001]
+//            [--max-mismatch 0] [--frames 4] [--width 400] [--height 300] [--scene cubes_512] [--out golden_diffs]
+
+class FrameDiff
+{
+    public:
+        int mismatched = 0;
+        int maxColorDiff = 0;
+        float maxDepthDiff = 0;
+        Frame image;
+
+        FrameDiff(Frame &reference, Frame &candidate, float far, int colorTolerance, float depthTolerance)
+        {
+            this->image = Frame(reference.width, reference.height);
+
+            for(int i = 0;i<reference.width * reference.height;i++)
+            {
+                int colorDiff = 0;
+                for(int c = 0;c<3;c++)
+                {
+                    colorDiff = std::max(colorDiff, abs(reference.rgb[3 * i + c] - candidate.rgb[3 * i + c]));
+                };
+
+                // pixels with nothing drawn hold the camera's far value, so compare coverage before depth
+                bool referenceCovered = reference.depth[i] < far;
+                bool candidateCovered = candidate.depth[i] < far;
+                float depthDiff = 0;
+                if(referenceCovered != candidateCovered){
+                    depthDiff = INFINITY;
+                } else if(referenceCovered){
+                    depthDiff = fabs(reference.depth[i] - candidate.depth[i]);
+                };
+
+                this->maxColorDiff = std::max(this->maxColorDiff, colorDiff);
+                this->maxDepthDiff = std::max(this->maxDepthDiff, depthDiff);
+
+                int x = i % reference.width;
+                int y = i / reference.width;
+                if(colorDiff > colorTolerance || depthDiff > depthTolerance){
+                    this->mismatched++;
+                    // color errors in red, depth errors in blue
+                    this->image.setPixel(x, y, colorDiff > colorTolerance ? 128 + colorDiff / 2 : 0, 0, depthDiff > depthTolerance ? 255 : 0);
+                } else {
+                    // matching pixels as a dim copy of the reference for context
+                    this->image.setPixel(x, y, reference.rgb[3 * i] / 4, reference.rgb[3 * i + 1] / 4, reference.rgb[3 * i + 2] / 4);
+                };
+            };
+        };
+};
+
+int main(int argc, char* argv[])
+{
+    int canvasWidth = 400;
+    int canvasHeight = 300;
+    int frames = 4;
+    std::string sceneFilter = "";
+    int threads = 1;
+    std::string outPath = "golden_diffs";
+    RenderConfig referenceConfig = RenderConfig::parse("simd=0");
+    RenderConfig candidateConfig = RenderConfig();
+    int colorTolerance = 0;
+    float depthTolerance = 0.001;
+    float maxMismatch = 0;
+
+    try {
+        for(int i = 1;i<argc;i++)
+        {
+            std::string arg = argv[i];
+            if(i + 1 >= argc){
+                throw std::invalid_argument("Missing value for " + arg);
+            };
+            std::string value = argv[++i];
+
+            if(arg == "--reference"){
+                referenceConfig = RenderConfig::parse(value);
+            } else if(arg == "--candidate"){
+                candidateConfig = RenderConfig::parse(value);
+            } else if(arg == "--color-tolerance"){
+                colorTolerance = std::stoi(value);
+            } else if(arg == "--depth-tolerance"){
+                depthTolerance = std::stof(value);
+            } else if(arg == "--max-mismatch"){
+                maxMismatch = std::stof(value);
+            } else if(arg == "--threads"){
+                threads = std::max(std::stoi(value), 1);
+            } else if(arg == "--frames"){
+                frames = std::max(std::stoi(value), 1);
+            } else if(arg == "--width"){
+                canvasWidth = std::stoi(value);
+            } else if(arg == "--height"){
+                canvasHeight = std::stoi(value);
+            } else if(arg == "--scene"){
+                sceneFilter = value;
+            } else if(arg == "--out"){
+                outPath = value;
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg);
+            };
+        };
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    };
+
+    // depth is only resolved on request, and the comparison needs it
+    referenceConfig.resolveDepth = true;
+    candidateConfig.resolveDepth = true;
+
+    JobSystem jobs = JobSystem(threads);
+    if(threads > 1){
+        candidateConfig.jobs = &jobs;
+    };
+
+    std::cout << "reference: " << referenceConfig.toString() << std::endl;
+    std::cout << "candidate: " << candidateConfig.toString() << ", threads=" << threads << std::endl;
+
+    std::vector<TestScene> suite = TestScene::Suite();
+    int failures = 0;
+    int cases = 0;
+
+    for(int i = 0;i<suite.size();i++)
+    {
+        if(sceneFilter != "" && suite[i].name != sceneFilter){
+            continue;
+        };
+
+        for(int f = 0;f<frames;f++)
+        {
+            Camera camera = suite[i].camera(f, frames);
+            Frame reference = camera.render(canvasWidth, canvasHeight, suite[i].scene, referenceConfig);
+            Frame candidate = camera.render(canvasWidth, canvasHeight, suite[i].scene, candidateConfig);
+
+            FrameDiff diff = FrameDiff(reference, candidate, camera.max + 1, colorTolerance, depthTolerance);
+            float mismatchRatio = float(diff.mismatched) / (canvasWidth * canvasHeight);
+            bool passed = mismatchRatio <= maxMismatch;
+            std::string name = suite[i].name + "_" + std::to_string(f);
+
+            cases++;
+            std::cout << (passed ? "PASS " : "FAIL ") << name << ": " << diff.mismatched << " mismatched (" << 100 * mismatchRatio << "%), max color diff " << diff.maxColorDiff << ", max depth diff " << diff.maxDepthDiff << std::endl;
+
+            if(!passed){
+                failures++;
+                std::filesystem::create_directories(outPath);
+                reference.savePPM(outPath + "/" + name + "_reference.ppm");
+                candidate.savePPM(outPath + "/" + name + "_candidate.ppm");
+                diff.image.savePPM(outPath + "/" + name + "_diff.ppm");
+            };
+        };
+    };
+
+    std::cout << cases - failures << "/" << cases << " passed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+class Job
+{
+    public:
+        std::function<void()> task;
+        // dependencies that have not finished yet, the job is queued when this reaches zero
+        std::atomic<int> pending;
+        std::atomic<bool> finished;
+        // what the task threw, or what a dependency failed with, in which case the task is skipped.
+        // written before finished is set, or before the job is queued when inherited from a dependency
+        std::exception_ptr error;
+        // guards dependents and an inherited error against a concurrent finish
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Job>> dependents;
+
+        Job(std::function<void()> task)
+        {
+            this->task = task;
+            this->pending = 0;
+            this->finished = false;
+        };
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+// owner pushes and pops at the back, thieves take from the front
+class WorkQueue
+{
+    public:
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+
+        void push(JobHandle job)
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->jobs.push_back(job);
+        };
+
+        JobHandle pop()
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if(this->jobs.empty()){
+                return nullptr;
+            };
+            JobHandle job = this->jobs.back();
+            this->jobs.pop_back();
+            return job;
+        };
+
+        JobHandle steal()
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if(this->jobs.empty()){
+                return nullptr;
+            };
+            JobHandle job = this->jobs.front();
+            this->jobs.pop_front();
+            return job;
+        };
+};
+
+// work stealing scheduler shared by every pipeline stage, so stages never spin up threads of their own.
+// threads that wait on a job run queued work instead of blocking, which makes nested parallelFor safe.
+// a task that throws still finishes its job: the exception skips the jobs that depend on it and is
+// rethrown by wait
+class JobSystem
+{
+    public:
+        JobSystem() : JobSystem(std::thread::hardware_concurrency())
+        {
+        };
+
+        // threadCount includes the calling thread, which does its share of the work while it waits
+        JobSystem(int threadCount)
+        {
+            this->threadCount = threadCount > 1 ? threadCount : 1;
+            this->running = true;
+            this->queued = 0;
+
+            // queue 0 belongs to threads outside the system
+            for(int i = 0;i<this->threadCount;i++)
+            {
+                this->queues.push_back(std::make_unique<WorkQueue>());
+            };
+            for(int i = 1;i<this->threadCount;i++)
+            {
+                this->workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+            };
+        };
+
+        ~JobSystem()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->sleepMutex);
+                this->running = false;
+            };
+            this->wake.notify_all();
+            for(int i = 0;i<this->workers.size();i++)
+            {
+                this->workers[i].join();
+            };
+        };
+
+        int size()
+        {
+            return this->threadCount;
+        };
+
+        JobHandle submit(std::function<void()> task, std::vector<JobHandle> dependencies = {})
+        {
+            JobHandle job = std::make_shared<Job>(task);
+
+            // one extra count held until every dependency is registered, so none can release the job early
+            job->pending = dependencies.size() + 1;
+            for(int i = 0;i<dependencies.size();i++)
+            {
+                std::lock_guard<std::mutex> lock(dependencies[i]->mutex);
+                if(dependencies[i]->finished){
+                    job->pending--;
+                    if(dependencies[i]->error){
+                        std::lock_guard<std::mutex> jobLock(job->mutex);
+                        if(!job->error){
+                            job->error = dependencies[i]->error;
+                        };
+                    };
+                } else {
+                    dependencies[i]->dependents.push_back(job);
+                };
+            };
+            this->release(job);
+
+            return job;
+        };
+
+        // runs other jobs on this thread until job is done, then rethrows what it failed with. when nothing is
+        // runnable, e.g. the job is still running on another thread, this spins on yield instead of sleeping,
+        // so keep waits short
+        void wait(JobHandle job)
+        {
+            this->waitFinished(job);
+            if(job->error){
+                std::rethrow_exception(job->error);
+            };
+        };
+
+        // waits for every job before rethrowing the first failure, so no job outlives what the caller unwinds
+        void wait(std::vector<JobHandle> &jobs)
+        {
+            for(int i = 0;i<jobs.size();i++)
+            {
+                this->waitFinished(jobs[i]);
+            };
+            for(int i = 0;i<jobs.size();i++)
+            {
+                if(jobs[i]->error){
+                    std::rethrow_exception(jobs[i]->error);
+                };
+            };
+        };
+
+        // splits [begin, end) into chunks of at most grain and calls body(chunkBegin, chunkEnd) for each, returns when all are done
+        void parallelFor(int begin, int end, int grain, std::function<void(int, int)> body)
+        {
+            if(end <= begin){
+                return;
+            };
+            grain = grain > 0 ? grain : 1;
+            if(this->threadCount == 1 || end - begin <= grain){
+                body(begin, end);
+                return;
+            };
+
+            std::vector<JobHandle> chunks;
+            chunks.reserve((end - begin + grain - 1) / grain);
+            for(int chunkBegin = begin;chunkBegin<end;chunkBegin+=grain)
+            {
+                int chunkEnd = chunkBegin + grain < end ? chunkBegin + grain : end;
+                chunks.push_back(this->submit([&body, chunkBegin, chunkEnd](){
+                    body(chunkBegin, chunkEnd);
+                }));
+            };
+            this->wait(chunks);
+        };
+
+    private:
+        int threadCount;
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<int> queued;
+
+        bool running;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+
+        // queue index of the current thread, 0 for threads that are not workers of this system
+        int queueIndex()
+        {
+            return JobSystem::currentSystem == this ? JobSystem::currentQueue : 0;
+        };
+
+        void waitFinished(JobHandle job)
+        {
+            while(!job->finished)
+            {
+                if(!this->runOne()){
+                    std::this_thread::yield();
+                };
+            };
+        };
+
+        void release(JobHandle job)
+        {
+            if(--job->pending > 0){
+                return;
+            };
+
+            this->queues[this->queueIndex()]->push(job);
+            this->queued++;
+            {
+                // taking the lock orders this against a worker that is about to sleep
+                std::lock_guard<std::mutex> lock(this->sleepMutex);
+            };
+            this->wake.notify_one();
+        };
+
+        JobHandle find()
+        {
+            int own = this->queueIndex();
+            JobHandle job = this->queues[own]->pop();
+            for(int i = 1;!job && i<this->threadCount;i++)
+            {
+                job = this->queues[(own + i) % this->threadCount]->steal();
+            };
+            return job;
+        };
+
+        bool runOne()
+        {
+            JobHandle job = this->find();
+            if(!job){
+                return false;
+            };
+            this->queued--;
+
+            if(!job->error){
+                try {
+                    job->task();
+                } catch(...) {
+                    job->error = std::current_exception();
+                };
+            };
+
+            std::vector<JobHandle> dependents;
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->finished = true;
+                dependents.swap(job->dependents);
+            };
+            for(int i = 0;i<dependents.size();i++)
+            {
+                if(job->error){
+                    std::lock_guard<std::mutex> lock(dependents[i]->mutex);
+                    if(!dependents[i]->error){
+                        dependents[i]->error = job->error;
+                    };
+                };
+                this->release(dependents[i]);
+            };
+
+            return true;
+        };
+
+        void workerLoop(int index)
+        {
+            JobSystem::currentSystem = this;
+            JobSystem::currentQueue = index;
+
+            while(true)
+            {
+                if(this->runOne()){
+                    continue;
+                };
+
+                std::unique_lock<std::mutex> lock(this->sleepMutex);
+                this->wake.wait(lock, [this](){
+                    return !this->running || this->queued > 0;
+                });
+                if(!this->running){
+                    return;
+                };
+            };
+        };
+
+        static inline thread_local JobSystem* currentSystem = nullptr;
+        static inline thread_local int currentQueue = 0;
+};
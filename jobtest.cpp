@@ -0,0 +1,299 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "jobs.h"
+
+// checks for JobSystem: dependency ordering, dependencies on finished jobs, nested parallelFor and
+// exceptions thrown by tasks, each run with several thread counts
+//
+//   ./jobtest [--rounds 50]
+
+class JobTest
+{
+    public:
+        std::string name;
+        std::function<bool(JobSystem&)> run;
+
+        JobTest(std::string name, std::function<bool(JobSystem&)> run)
+        {
+            this->name = name;
+            this->run = run;
+        };
+};
+
+// diamond a -> (b, c) -> d, every job checks its dependencies already ran
+bool diamond(JobSystem &jobs)
+{
+    std::atomic<int> a(0), b(0), c(0), d(0);
+    std::atomic<bool> ordered(true);
+
+    JobHandle jobA = jobs.submit([&](){
+        a = 1;
+    });
+    JobHandle jobB = jobs.submit([&](){
+        if(a != 1){
+            ordered = false;
+        };
+        b = 1;
+    }, { jobA });
+    JobHandle jobC = jobs.submit([&](){
+        if(a != 1){
+            ordered = false;
+        };
+        c = 1;
+    }, { jobA });
+    JobHandle jobD = jobs.submit([&](){
+        if(b != 1 || c != 1){
+            ordered = false;
+        };
+        d = 1;
+    }, { jobB, jobC });
+
+    jobs.wait(jobD);
+    return ordered && d == 1 && jobA->finished && jobB->finished && jobC->finished;
+};
+
+// long chain submitted front to back, so most links are registered while their dependency is still queued
+bool chain(JobSystem &jobs)
+{
+    int length = 200;
+    std::atomic<int> next(0);
+    std::atomic<bool> ordered(true);
+
+    std::vector<JobHandle> links;
+    for(int i = 0;i<length;i++)
+    {
+        std::vector<JobHandle> dependencies;
+        if(i > 0){
+            dependencies.push_back(links[i - 1]);
+        };
+        links.push_back(jobs.submit([&next, &ordered, i](){
+            if(next.fetch_add(1) != i){
+                ordered = false;
+            };
+        }, dependencies));
+    };
+
+    jobs.wait(links.back());
+    return ordered && next == length;
+};
+
+// dependencies that finished before the dependent was submitted must not hold it back
+bool finishedDependency(JobSystem &jobs)
+{
+    std::atomic<int> ran(0);
+    JobHandle first = jobs.submit([&](){
+        ran++;
+    });
+    jobs.wait(first);
+
+    JobHandle second = jobs.submit([&](){
+        ran++;
+    }, { first, first });
+    jobs.wait(second);
+
+    return ran == 2;
+};
+
+// many jobs joining on one shared dependency, submitted from inside other jobs
+bool fanIn(JobSystem &jobs)
+{
+    int count = 64;
+    std::atomic<int> gate(0);
+    std::atomic<int> after(0);
+    std::atomic<bool> ordered(true);
+
+    JobHandle root = jobs.submit([&](){
+        gate = 1;
+    });
+    std::vector<JobHandle> dependents(count);
+    jobs.parallelFor(0, count, 1, [&](int begin, int end){
+        for(int i = begin;i<end;i++)
+        {
+            dependents[i] = jobs.submit([&](){
+                if(gate != 1){
+                    ordered = false;
+                };
+                after++;
+            }, { root });
+        };
+    });
+    jobs.wait(dependents);
+
+    return ordered && after == count;
+};
+
+// parallelFor inside parallelFor, every cell of the grid written exactly once
+bool nestedParallelFor(JobSystem &jobs)
+{
+    int rows = 37;
+    int columns = 53;
+    std::vector<std::atomic<int>> cells(rows * columns);
+    for(int i = 0;i<cells.size();i++)
+    {
+        cells[i] = 0;
+    };
+
+    jobs.parallelFor(0, rows, 3, [&](int rowBegin, int rowEnd){
+        for(int y = rowBegin;y<rowEnd;y++)
+        {
+            jobs.parallelFor(0, columns, 4, [&](int columnBegin, int columnEnd){
+                for(int x = columnBegin;x<columnEnd;x++)
+                {
+                    cells[y * columns + x]++;
+                };
+            });
+        };
+    });
+
+    for(int i = 0;i<cells.size();i++)
+    {
+        if(cells[i] != 1){
+            return false;
+        };
+    };
+    return true;
+};
+
+// a throwing task finishes its job, wait rethrows, and a dependent is skipped but fails the same way
+bool throwingDependency(JobSystem &jobs)
+{
+    std::atomic<bool> dependentRan(false);
+
+    JobHandle failing = jobs.submit([](){
+        throw std::runtime_error("task failed");
+    });
+    JobHandle dependent = jobs.submit([&](){
+        dependentRan = true;
+    }, { failing });
+
+    bool failingThrew = false;
+    try {
+        jobs.wait(failing);
+    } catch(std::runtime_error &e) {
+        failingThrew = std::string(e.what()) == "task failed";
+    };
+    bool dependentThrew = false;
+    try {
+        jobs.wait(dependent);
+    } catch(std::runtime_error &e) {
+        dependentThrew = true;
+    };
+
+    // a job submitted after the failure inherits it too
+    JobHandle late = jobs.submit([&](){
+        dependentRan = true;
+    }, { failing });
+    bool lateThrew = false;
+    try {
+        jobs.wait(late);
+    } catch(std::runtime_error &e) {
+        lateThrew = true;
+    };
+
+    return failingThrew && dependentThrew && lateThrew && !dependentRan && failing->finished && dependent->finished;
+};
+
+// parallelFor rethrows only after every chunk is done, and the system keeps working afterwards
+bool throwingParallelFor(JobSystem &jobs)
+{
+    int count = 64;
+    std::atomic<int> done(0);
+
+    bool threw = false;
+    try {
+        jobs.parallelFor(0, count, 1, [&](int begin, int end){
+            for(int i = begin;i<end;i++)
+            {
+                if(i == count / 2){
+                    throw std::runtime_error("chunk failed");
+                };
+                done++;
+            };
+        });
+    } catch(std::runtime_error &e) {
+        threw = true;
+    };
+    // nothing may still be running once parallelFor has thrown. a single thread runs the range as one
+    // call, which stops at the throw
+    bool allDone = done == (jobs.size() == 1 ? count / 2 : count - 1);
+
+    std::atomic<int> after(0);
+    jobs.parallelFor(0, count, 1, [&](int begin, int end){
+        after += end - begin;
+    });
+
+    return threw && allDone && after == count;
+};
+
+int main(int argc, char* argv[])
+{
+    int rounds = 50;
+
+    try {
+        for(int i = 1;i<argc;i++)
+        {
+            std::string arg = argv[i];
+            if(i + 1 >= argc){
+                throw std::invalid_argument("Missing value for " + arg);
+            };
+            std::string value = argv[++i];
+
+            if(arg == "--rounds"){
+                rounds = std::max(std::stoi(value), 1);
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg);
+            };
+        };
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    };
+
+    std::vector<JobTest> tests = {
+        JobTest("diamond", diamond),
+        JobTest("chain", chain),
+        JobTest("finished_dependency", finishedDependency),
+        JobTest("fan_in", fanIn),
+        JobTest("nested_parallel_for", nestedParallelFor),
+        JobTest("throwing_dependency", throwingDependency),
+        JobTest("throwing_parallel_for", throwingParallelFor)
+    };
+    std::vector<int> threadCounts = { 1, 2, 4, 8 };
+
+    int failures = 0;
+    int cases = 0;
+
+    for(int t = 0;t<threadCounts.size();t++)
+    {
+        JobSystem jobs = JobSystem(threadCounts[t]);
+
+        for(int i = 0;i<tests.size();i++)
+        {
+            // repeated so interleavings that only fail occasionally get a chance to show up
+            int failedRounds = 0;
+            for(int r = 0;r<rounds;r++)
+            {
+                if(!tests[i].run(jobs)){
+                    failedRounds++;
+                };
+            };
+
+            bool passed = failedRounds == 0;
+            cases++;
+            if(!passed){
+                failures++;
+            };
+            std::cout << (passed ? "PASS " : "FAIL ") << tests[i].name << ", threads=" << threadCounts[t] << ": " << failedRounds << "/" << rounds << " rounds failed" << std::endl;
+        };
+    };
+
+    std::cout << cases - failures << "/" << cases << " passed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+};
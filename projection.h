@@ -0,0 +1,1410 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <functional>
+#include <cstdint>
+
+#include "jobs.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+class V3
+{
+    public:
+        float x;
+        float y;
+        float z;
+
+        V3()
+        {
+            this->x = 0;
+            this->y = 0;
+            this->z = 0;
+        };
+
+        V3(float x, float y, float z){
+            this->x = x;
+            this->y = y;
+            this->z = z;
+        }
+        
+        V3 operator + (V3 const &v)
+        {
+            return V3(this->x + v.x, this->y + v.y, this->z + v.z);
+        };
+
+        V3 operator - (V3 const &v)
+        {
+            return V3(this->x - v.x, this->y - v.y, this->z - v.z);
+        };
+
+        // flip
+        V3 operator - ()
+        {
+            return V3(-this->x, -this->y, -this->z);
+        };
+
+        // scalar multiply
+        V3 operator * (float s)
+        {
+            return V3(this->x * s, this->y * s, this->z * s);
+        };
+
+        // dot product
+        float operator * (V3 v)
+        {
+            return this->x * v.x + this->y * v.y + this->z * v.z;
+        };
+
+        // piecewise multiply
+        V3 operator & (V3 v)
+        {
+            return V3(this->x * v.x, this->y * v.y, this->z * v.z);
+        };
+
+        // cross product
+        V3 operator ^ (V3 v)
+        {
+            return V3(
+                this->y * v.z - this->z * v.y,
+                this->x * v.z - this->z * v.x,
+                this->x * v.y - this->y * v.x
+            );
+        };
+
+        // normal
+        V3 operator ~ ()
+        {
+            float m = sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
+            return *this * (1 / m);
+        };
+
+        V3 rotate(float cosX, float sinX, float cosY, float sinY, float cosZ, float sinZ)
+        {
+            V3 rotated = V3(this->x, this->y, this->z);
+            float temp;
+
+            // y axis
+            temp = rotated.x * cosY + rotated.z * sinY;
+            rotated.z = -rotated.x  * sinY + rotated.z * cosY;
+            rotated.x = temp;
+
+            // x axis
+            temp = rotated.y * cosX - rotated.z * sinX;
+            rotated.z = rotated.y * sinX + rotated.z * cosX;
+            rotated.y = temp;
+
+            // z axis
+            temp = rotated.x * cosZ - rotated.y * sinZ;
+            rotated.y = rotated.x * sinZ + rotated.y * cosZ;
+            rotated.x = temp;
+
+            return rotated;
+        };
+
+        std::string toString()
+        {
+            return "<" + std::to_string(this->x) + ", " + std::to_string(this->y) + ", " + std::to_string(this->z) + ">";
+        };
+};
+
+class Transform
+{
+    public:
+        V3 pos;
+        V3 scale;
+        V3 rot;
+
+        float cosX;
+        float sinX;
+        float cosY;
+        float sinY;
+        float cosZ;
+        float sinZ;
+
+        void setRotX(float rotX)
+        {
+            this->rot.x = rotX;
+            this->cosX = cos(rotX);
+            this->sinX = sin(rotX);
+        };
+
+        void setRotY(float rotY)
+        {
+            this->rot.y = rotY;
+            this->cosY = cos(rotY);
+            this->sinY = sin(rotY);
+        };
+
+        void setRotZ(float rotZ)
+        {
+            this->rot.z = rotZ;
+            this->cosZ = cos(rotZ);
+            this->sinZ = sin(rotZ);
+        };
+
+        void changeRotX(float deltaRotX)
+        {
+            this->setRotX(this->rot.x + deltaRotX);
+        };
+
+        void changeRotY(float deltaRotY)
+        {
+            this->setRotY(this->rot.y + deltaRotY);
+        };
+
+        void changeRotZ(float deltaRotZ)
+        {
+            this->setRotZ(this->rot.z + deltaRotZ);
+        };
+
+        void setRot(float rotX, float rotY, float rotZ)
+        {
+            this->setRotX(rotX);
+            this->setRotY(rotY);
+            this->setRotZ(rotZ);
+        };
+
+        Transform()
+        {
+            this->pos = V3();
+            this->scale = V3(1, 1, 1);
+            this->setRot(0, 0, 0);
+        };
+
+        Transform(V3 pos, V3 scale, V3 rot)
+        {
+            this->pos = pos;
+            this->scale = scale;
+            this->setRot(rot.x, rot.y, rot.z);
+        };
+};
+
+// 0xAABBGGRR, so the bytes sit in memory as r, g, b, a
+inline uint32_t packColor(V3 color, int alpha = 255)
+{
+    int r = fmin(fmax(color.x + 0.5, 0), 255);
+    int g = fmin(fmax(color.y + 0.5, 0), 255);
+    int b = fmin(fmax(color.z + 0.5, 0), 255);
+    return r | g << 8 | b << 16 | uint32_t(alpha) << 24;
+};
+
+class Material
+{
+    public:
+        V3 ambientColor;
+        V3 diffuseColor;
+
+        Material()
+        {
+            this->ambientColor = V3();
+            this->diffuseColor = V3();
+        };
+
+        Material(V3 ambientColor, V3 diffuseColor)
+        {
+            this->ambientColor = ambientColor;
+            this->diffuseColor = diffuseColor;
+        };
+};
+
+class Primitive
+{
+    public:
+        V3 p1;
+        V3 p2;
+        V3 p3;
+        bool cullable;
+        // index into the owning SceneObject's materials
+        uint16_t material;
+
+        Primitive()
+        {
+            this->p1 = V3();
+            this->p2 = V3();
+            this->p3 = V3();
+            this->cullable = false;
+            this->material = 0;
+        };
+
+        Primitive(V3 p1, V3 p2, V3 p3, bool cullable, uint16_t material)
+        {
+            this->p1 = p1;
+            this->p2 = p2;
+            this->p3 = p3;
+            this->cullable = cullable;
+            this->material = material;
+        };
+
+        Primitive transformGeometry(Transform transform, bool rotateFirst)
+        {
+            if(rotateFirst){
+                return Primitive(
+                    (this->p1 & transform.scale).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ) + transform.pos,
+                    (this->p2 & transform.scale).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ) + transform.pos,
+                    (this->p3 & transform.scale).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ) + transform.pos,
+                    this->cullable,
+                    this->material
+                );
+            } else {
+                return Primitive(
+                    ((this->p1 & transform.scale) + transform.pos).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ),
+                    ((this->p2 & transform.scale) + transform.pos).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ),
+                    ((this->p3 & transform.scale) + transform.pos).rotate(transform.cosX, transform.sinX, transform.cosY, transform.sinY, transform.cosZ, transform.sinZ),
+                    this->cullable,
+                    this->material
+                );
+            };
+        };
+
+        void print()
+        {
+            std::cout << "Primitive: " << std::endl << "\t" << this->p1.toString() << std::endl << "\t" << this->p2.toString() << std::endl << "\t" << this->p3.toString() << std::endl << std::endl;
+        };
+};
+
+class SceneObject
+{
+    public:
+        std::vector<Primitive> primitives;
+        std::vector<Material> materials;
+        Transform internalTransform;
+
+        SceneObject()
+        {
+            this->primitives = {};
+            this->materials = {};
+            this->internalTransform = Transform();
+        };
+
+        SceneObject(std::vector<Primitive> primitives, std::vector<Material> materials, Transform internalTransform)
+        {
+            this->primitives = primitives;
+            this->materials = materials;
+            this->internalTransform = internalTransform;
+        };
+
+        SceneObject transformGeometry(Transform transform, bool rotateFirst)
+        {
+            std::vector<Primitive> transformedPrimitives;
+            transformedPrimitives.reserve(this->primitives.size());
+            for(int i = 0;i<this->primitives.size();i++)
+            {
+                transformedPrimitives.push_back(this->primitives[i].transformGeometry(transform, rotateFirst));
+            };
+            return SceneObject(transformedPrimitives, this->materials, this->internalTransform);
+        };
+
+        static SceneObject ColoredUnitCube(V3 pos)
+        {
+            return SceneObject(
+                {
+                    // back face
+                    Primitive(
+                        V3(-1, -1, 1),
+                        V3(1, -1, 1),
+                        V3(1, 1, 1),
+                        true,
+                        0
+                    ),
+                    Primitive(
+                        V3(-1, -1, 1),
+                        V3(1, 1, 1),
+                        V3(-1, 1, 1),
+                        true,
+                        0
+                    ),
+                    // right face
+                    Primitive(
+                        V3(1, -1, 1),
+                        V3(1, -1, -1),
+                        V3(1, 1, -1),
+                        true,
+                        1
+                    ),
+                    Primitive(
+                        V3(1, -1, 1),
+                        V3(1, 1, -1),
+                        V3(1, 1, 1),
+                        true,
+                        1
+                    ),
+                    // front face
+                    Primitive(
+                        V3(1, -1, -1),
+                        V3(-1, -1, -1),
+                        V3(-1, 1, -1),
+                        true,
+                        2
+                    ),
+                    Primitive(
+                        V3(1, -1, -1),
+                        V3(-1, 1, -1),
+                        V3(1, 1, -1),
+                        true,
+                        2
+                    ),
+                    // left face
+                    Primitive(
+                        V3(-1, -1, -1),
+                        V3(-1, -1, 1),
+                        V3(-1, 1, 1),
+                        true,
+                        3
+                    ),
+                    Primitive(
+                        V3(-1, -1, -1),
+                        V3(-1, 1, 1),
+                        V3(-1, 1, -1),
+                        true,
+                        3
+                    ),
+                    // bottom face
+                    Primitive(
+                        V3(-1, -1, -1),
+                        V3(1, -1, -1),
+                        V3(1, -1, 1),
+                        true,
+                        4
+                    ),
+                    Primitive(
+                        V3(-1, -1, -1),
+                        V3(1, -1, 1),
+                        V3(-1, -1, 1),
+                        true,
+                        4
+                    ),
+                    // top face
+                    Primitive(
+                        V3(-1, 1, -1),
+                        V3(1, 1, 1),
+                        V3(1, 1, -1),
+                        true,
+                        5
+                    ),
+                    Primitive(
+                        V3(-1, 1, -1),
+                        V3(-1, 1, 1),
+                        V3(1, 1, 1),
+                        true,
+                        5
+                    )
+                },
+                {
+                    Material(V3(255, 0, 0), V3(255, 0, 0)),
+                    Material(V3(0, 0, 255), V3(0, 0, 255)),
+                    Material(V3(0, 255, 0), V3(0, 255, 0)),
+                    Material(V3(255, 100, 0), V3(255, 100, 0)),
+                    Material(V3(255, 0, 255), V3(255, 0, 255)),
+                    Material(V3(255, 255, 0), V3(255, 255, 0))
+                },
+                Transform(pos, V3(1, 1, 1), V3())
+            );
+        };
+};
+
+class SceneLight
+{
+    public:
+        V3 pos;
+        V3 color;
+        float strength;
+
+        SceneLight()
+        {
+            this->pos = V3();
+            this->color = V3();
+            this->strength = 0;
+        };
+
+        SceneLight(V3 pos, V3 color, float strength)
+        {
+            this->pos = pos;
+            this->color = color;
+            this->strength = strength;
+        };
+};
+
+class Scene
+{
+    public:
+        std::vector<SceneObject> objects;
+        std::vector<SceneLight> lights;
+};
+
+// scene objects moved into world space by their internal transforms. only depends on the scene,
+// so every view of the same scene can share one, read only
+class WorldScene
+{
+    public:
+        std::vector<SceneObject> objects;
+        // each object's material table as packed ambient colors, which is all the rasterizer reads
+        std::vector<std::vector<uint32_t>> palettes;
+
+        WorldScene()
+        {
+            this->objects = {};
+            this->palettes = {};
+        };
+
+        WorldScene(Scene &scene, JobSystem* jobs)
+        {
+            this->objects = std::vector<SceneObject>(scene.objects.size());
+            this->palettes = std::vector<std::vector<uint32_t>>(scene.objects.size());
+
+            std::function<void(int, int)> transformObjects = [&](int begin, int end){
+                for(int i = begin;i<end;i++)
+                {
+                    // the rasterizer indexes palettes unchecked
+                    std::vector<Primitive> &primitives = scene.objects[i].primitives;
+                    for(int j = 0;j<primitives.size();j++)
+                    {
+                        if(primitives[j].material >= scene.objects[i].materials.size()){
+                            throw std::invalid_argument("Primitive " + std::to_string(j) + " of object " + std::to_string(i) + " uses material " + std::to_string(primitives[j].material) + " of " + std::to_string(scene.objects[i].materials.size()));
+                        };
+                    };
+
+                    this->objects[i] = scene.objects[i].transformGeometry(scene.objects[i].internalTransform, true);
+
+                    this->palettes[i].reserve(scene.objects[i].materials.size());
+                    for(int j = 0;j<scene.objects[i].materials.size();j++)
+                    {
+                        this->palettes[i].push_back(packColor(scene.objects[i].materials[j].ambientColor));
+                    };
+                };
+            };
+            if(jobs){
+                jobs->parallelFor(0, scene.objects.size(), 16, transformObjects);
+            } else {
+                transformObjects(0, scene.objects.size());
+            };
+        };
+};
+
+enum DepthFormat
+{
+    // linearly interpolated view space z, the original format
+    DEPTH_VIEW_Z,
+    // 1 / z, which is linear in screen space, as float
+    DEPTH_INVERSE_32,
+    // 1 / z scaled so near maps to 1, as 16 bit unorm
+    DEPTH_INVERSE_16
+};
+
+// depth plane kept apart from color so the depth test only touches depth. inverse formats are reversed:
+// bigger is nearer and the buffer clears to 0, which keeps float precision where 1 / z changes fastest
+class DepthBuffer
+{
+    public:
+        DepthFormat format;
+        // camera near clip plane, stored as 1 in DEPTH_INVERSE_16
+        float near;
+        // view space z reported for samples nothing was drawn to
+        float far;
+        std::vector<float> depth32;
+        std::vector<uint16_t> depth16;
+
+        DepthBuffer()
+        {
+            this->format = DEPTH_VIEW_Z;
+            this->near = 1;
+            this->far = 0;
+        };
+
+        DepthBuffer(DepthFormat format, int size, float near, float far)
+        {
+            this->format = format;
+            this->near = near;
+            this->far = far;
+            if(format == DEPTH_INVERSE_16){
+                this->depth16 = std::vector<uint16_t>(size, 0);
+            } else {
+                this->depth32 = std::vector<float>(size, format == DEPTH_VIEW_Z ? far : 0);
+            };
+        };
+
+        // depth is view space z for DEPTH_VIEW_Z and 1 / z otherwise, stores it and returns true when nearer
+        bool test(int index, float depth)
+        {
+            if(this->format == DEPTH_VIEW_Z){
+                if(this->depth32[index] > depth){
+                    this->depth32[index] = depth;
+                    return true;
+                };
+            } else if(this->format == DEPTH_INVERSE_32){
+                if(this->depth32[index] < depth){
+                    this->depth32[index] = depth;
+                    return true;
+                };
+            } else {
+                float scaled = depth * this->near;
+                uint16_t encoded = scaled >= 1 ? 65535 : scaled * 65535 + 0.5;
+                if(this->depth16[index] < encoded){
+                    this->depth16[index] = encoded;
+                    return true;
+                };
+            };
+            return false;
+        };
+
+        // view space z of the nearest sample in the size x size block whose top left is index, decoded once
+        float nearestViewZ(int index, int stride, int size)
+        {
+            if(this->format == DEPTH_INVERSE_16){
+                uint16_t nearest = 0;
+                for(int j = 0;j<size;j++)
+                {
+                    for(int i = 0;i<size;i++)
+                    {
+                        uint16_t sample = this->depth16[index + j * stride + i];
+                        nearest = sample > nearest ? sample : nearest;
+                    };
+                };
+                return nearest > 0 ? this->near * 65535 / nearest : this->far;
+            };
+
+            // negating view z lets both float formats keep the biggest value
+            float sign = this->format == DEPTH_VIEW_Z ? -1 : 1;
+            float nearest = -INFINITY;
+            for(int j = 0;j<size;j++)
+            {
+                for(int i = 0;i<size;i++)
+                {
+                    float sample = sign * this->depth32[index + j * stride + i];
+                    nearest = sample > nearest ? sample : nearest;
+                };
+            };
+            if(this->format == DEPTH_VIEW_Z){
+                return -nearest;
+            };
+            return nearest > 0 ? 1 / nearest : this->far;
+        };
+};
+
+// supersampled render target, row major
+class FrameBuffer
+{
+    public:
+        int width;
+        int height;
+        // packed with packColor
+        std::vector<uint32_t> color;
+        DepthBuffer depth;
+
+        FrameBuffer(int width, int height, DepthFormat depthFormat, float near, float far)
+        {
+            this->width = width;
+            this->height = height;
+            this->color = std::vector<uint32_t>(width * height, packColor(V3(0, 0, 0)));
+            this->depth = DepthBuffer(depthFormat, width * height, near, far);
+        };
+};
+
+// box filters two rows of packed samples into count packed pixels, truncating like the original float resolve
+inline void downsampleRow2x2(const uint32_t* top, const uint32_t* bottom, int count, uint32_t* out)
+{
+    int x = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    for(;x + 4<=count;x+=4)
+    {
+        __m128i top0 = _mm_loadu_si128((const __m128i*) (top + 2 * x));
+        __m128i top1 = _mm_loadu_si128((const __m128i*) (top + 2 * x + 4));
+        __m128i bottom0 = _mm_loadu_si128((const __m128i*) (bottom + 2 * x));
+        __m128i bottom1 = _mm_loadu_si128((const __m128i*) (bottom + 2 * x + 4));
+
+        // widen to 16 bit channels and add the rows, each register holds two adjacent columns
+        __m128i columns01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+        __m128i columns23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+        __m128i columns45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+        __m128i columns67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+        // add each even column to the odd one after it
+        __m128i pixels01 = _mm_add_epi16(_mm_unpacklo_epi64(columns01, columns23), _mm_unpackhi_epi64(columns01, columns23));
+        __m128i pixels23 = _mm_add_epi16(_mm_unpacklo_epi64(columns45, columns67), _mm_unpackhi_epi64(columns45, columns67));
+
+        __m128i pixels = _mm_packus_epi16(_mm_srli_epi16(pixels01, 2), _mm_srli_epi16(pixels23, 2));
+        _mm_storeu_si128((__m128i*) (out + x), pixels);
+    };
+#endif
+    for(;x<count;x++)
+    {
+        uint32_t samples[4] = { top[2 * x], top[2 * x + 1], bottom[2 * x], bottom[2 * x + 1] };
+        uint32_t pixel = 0;
+        for(int shift = 0;shift<32;shift+=8)
+        {
+            uint32_t sum = 0;
+            for(int i = 0;i<4;i++)
+            {
+                sum += samples[i] >> shift & 255;
+            };
+            pixel |= sum / 4 << shift;
+        };
+        out[x] = pixel;
+    };
+};
+
+class Frame
+{
+    public:
+        int width;
+        int height;
+        std::vector<unsigned char> rgb;
+        // view space z of the nearest sample under each pixel, empty for frames rendered without RenderConfig::resolveDepth
+        std::vector<float> depth;
+
+        Frame()
+        {
+            this->width = 0;
+            this->height = 0;
+            this->rgb = {};
+            this->depth = {};
+        };
+
+        Frame(int width, int height, bool withDepth = true)
+        {
+            this->width = width;
+            this->height = height;
+            this->rgb = std::vector<unsigned char>(3 * width * height, 0);
+            this->depth = withDepth ? std::vector<float>(width * height, 0) : std::vector<float>();
+        };
+
+        void setPixel(int x, int y, int r, int g, int b)
+        {
+            int index = 3 * (y * this->width + x);
+            this->rgb[index] = r;
+            this->rgb[index + 1] = g;
+            this->rgb[index + 2] = b;
+        };
+
+        bool savePPM(std::string path)
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << "P6\n" << this->width << " " << this->height << "\n255\n";
+            file.write((char*) this->rgb.data(), this->rgb.size());
+            // closing flushes, which is where a full disk shows up for small files
+            file.close();
+            return !file.fail();
+        };
+
+        // bilinear color, nearest depth
+        Frame resized(int width, int height)
+        {
+            bool withDepth = !this->depth.empty();
+            Frame resized = Frame(width, height, withDepth);
+            float scaleX = float(this->width) / width;
+            float scaleY = float(this->height) / height;
+
+            for(int y = 0;y<height;y++)
+            {
+                float sourceY = fmin(fmax((y + 0.5) * scaleY - 0.5, 0), this->height - 1);
+                int y0 = sourceY;
+                int y1 = y0 + 1 < this->height ? y0 + 1 : y0;
+                float ty = sourceY - y0;
+
+                for(int x = 0;x<width;x++)
+                {
+                    float sourceX = fmin(fmax((x + 0.5) * scaleX - 0.5, 0), this->width - 1);
+                    int x0 = sourceX;
+                    int x1 = x0 + 1 < this->width ? x0 + 1 : x0;
+                    float tx = sourceX - x0;
+
+                    for(int c = 0;c<3;c++)
+                    {
+                        float top = this->rgb[3 * (y0 * this->width + x0) + c] * (1 - tx) + this->rgb[3 * (y0 * this->width + x1) + c] * tx;
+                        float bottom = this->rgb[3 * (y1 * this->width + x0) + c] * (1 - tx) + this->rgb[3 * (y1 * this->width + x1) + c] * tx;
+                        resized.rgb[3 * (y * width + x) + c] = top * (1 - ty) + bottom * ty + 0.5;
+                    };
+
+                    if(withDepth){
+                        int nearestX = fmin((x + 0.5) * scaleX, this->width - 1);
+                        int nearestY = fmin((y + 0.5) * scaleY, this->height - 1);
+                        resized.depth[y * width + x] = this->depth[nearestY * this->width + nearestX];
+                    };
+                };
+            };
+
+            return resized;
+        };
+};
+
+class RenderConfig
+{
+    public:
+        // samples per pixel along each axis, resolved with a box filter
+        int supersample = 2;
+        // internal resolution as a fraction of the canvas, upscaled during resolve
+        float renderScale = 1;
+        DepthFormat depthFormat = DEPTH_INVERSE_32;
+        // use the SSE2 kernel for the 2x2 box filter when available
+        bool simdResolve = true;
+        // also resolve the depth plane into Frame::depth, only tests read it
+        bool resolveDepth = false;
+        // stages run serially when null
+        JobSystem* jobs = nullptr;
+
+        // the original pipeline, kept as the baseline faster paths are checked against
+        static RenderConfig Reference()
+        {
+            RenderConfig config = RenderConfig();
+            config.supersample = 2;
+            config.renderScale = 1;
+            config.depthFormat = DEPTH_VIEW_Z;
+            config.simdResolve = false;
+            config.jobs = nullptr;
+            return config;
+        };
+
+        // comma separated key=value list applied over the defaults, e.g. "supersample=4",
+        // a "reference" entry starts over from RenderConfig::Reference instead
+        static RenderConfig parse(std::string spec)
+        {
+            RenderConfig config = RenderConfig();
+
+            std::stringstream stream(spec);
+            std::string entry;
+            while(std::getline(stream, entry, ','))
+            {
+                if(entry == ""){
+                    continue;
+                };
+                if(entry == "reference"){
+                    config = RenderConfig::Reference();
+                    continue;
+                };
+
+                size_t split = entry.find('=');
+                if(split == std::string::npos){
+                    throw std::invalid_argument("Expected key=value in render config: " + entry);
+                };
+                std::string key = entry.substr(0, split);
+                std::string value = entry.substr(split + 1);
+
+                if(key == "supersample"){
+                    config.supersample = std::stoi(value);
+                    if(config.supersample < 1){
+                        throw std::invalid_argument("supersample must be at least 1");
+                    };
+                } else if(key == "depth"){
+                    if(value == "viewz"){
+                        config.depthFormat = DEPTH_VIEW_Z;
+                    } else if(value == "inverse32"){
+                        config.depthFormat = DEPTH_INVERSE_32;
+                    } else if(value == "inverse16"){
+                        config.depthFormat = DEPTH_INVERSE_16;
+                    } else {
+                        throw std::invalid_argument("depth must be viewz, inverse32 or inverse16");
+                    };
+                } else if(key == "simd"){
+                    config.simdResolve = std::stoi(value) != 0;
+                } else if(key == "resolvedepth"){
+                    config.resolveDepth = std::stoi(value) != 0;
+                } else if(key == "scale"){
+                    config.renderScale = std::stof(value);
+                    if(config.renderScale <= 0 || config.renderScale > 1){
+                        throw std::invalid_argument("scale must be in (0, 1]");
+                    };
+                } else {
+                    throw std::invalid_argument("Unknown render config key: " + key);
+                };
+            };
+
+            return config;
+        };
+
+        std::string toString()
+        {
+            std::string depthNames[] = { "viewz", "inverse32", "inverse16" };
+            return "supersample=" + std::to_string(this->supersample) + ",scale=" + std::to_string(this->renderScale) + ",depth=" + depthNames[this->depthFormat] + ",simd=" + std::to_string(this->simdResolve) + ",resolvedepth=" + std::to_string(this->resolveDepth);
+        };
+};
+
+class RenderStats
+{
+    public:
+        // stage times in ms
+        float bufferTime = 0;
+        float transformTime = 0;
+        float rasterTime = 0;
+        float resolveTime = 0;
+        float totalTime = 0;
+
+        int trianglesIn = 0;
+        int trianglesRastered = 0;
+        // supersamples inside the buffer that went through the depth test
+        long samplesTested = 0;
+        long samplesWritten = 0;
+};
+
+// adjusts RenderConfig::renderScale and RenderConfig::supersample each frame to hold a frame time budget
+class ResolutionController
+{
+    public:
+        RenderConfig config;
+        // target ms per frame
+        float budget;
+        float minScale;
+        int minSupersample;
+        int maxSupersample;
+        // smoothed render cost in ms
+        float renderCost;
+
+        ResolutionController()
+        {
+            this->config = RenderConfig();
+            this->budget = 16.6;
+            this->minScale = 0.25;
+            this->minSupersample = 1;
+            this->maxSupersample = 2;
+            this->renderCost = 0;
+        };
+
+        ResolutionController(RenderConfig config, float budget, float minScale, int minSupersample, int maxSupersample)
+        {
+            this->config = config;
+            this->budget = budget;
+            this->minScale = minScale;
+            this->minSupersample = minSupersample;
+            this->maxSupersample = maxSupersample;
+            this->renderCost = 0;
+        };
+
+        // renderTime is what Camera::render took, frameTime the whole frame including presentation and input
+        void update(float renderTime, float frameTime)
+        {
+            if(renderTime <= 0){
+                return;
+            };
+            this->renderCost = this->renderCost == 0 ? renderTime : 0.8 * this->renderCost + 0.2 * renderTime;
+
+            // whatever the frame spends outside render does not shrink with resolution
+            float renderBudget = fmax(this->budget - fmax(frameTime - renderTime, 0), 0.1 * this->budget);
+            float load = this->renderCost / renderBudget;
+
+            // cost scales roughly with the sample count, so with the square of both scale and supersample.
+            // over budget antialiasing goes first, under budget resolution comes back first
+            int supersample = this->config.supersample;
+            float step = fmin(fmax(sqrt(0.9 / load), 0.8), 1.1);
+            if(load > 1){
+                if(supersample > this->minSupersample){
+                    this->config.supersample = supersample - 1;
+                    this->renderCost *= float((supersample - 1) * (supersample - 1)) / (supersample * supersample);
+                } else {
+                    this->setRenderScale(fmax(this->config.renderScale * step, this->minScale));
+                };
+            } else if(load < 0.8){
+                if(this->config.renderScale < 1){
+                    this->setRenderScale(fmin(this->config.renderScale * step, 1));
+                } else if(supersample < this->maxSupersample && load * (supersample + 1) * (supersample + 1) / (supersample * supersample) < 0.9){
+                    this->config.supersample = supersample + 1;
+                    this->renderCost *= float((supersample + 1) * (supersample + 1)) / (supersample * supersample);
+                };
+            };
+        };
+
+    private:
+        // carries the smoothed cost over to the new scale, otherwise the old cost keeps pushing the scale further
+        void setRenderScale(float scale)
+        {
+            float ratio = scale / this->config.renderScale;
+            this->renderCost *= ratio * ratio;
+            this->config.renderScale = scale;
+        };
+};
+
+class Camera
+{
+    public:
+        V3 pos;
+        V3 rot;
+        float fov;
+        float focal;
+        float min;
+        float max;
+        bool renderProcessLogs = false;
+        RenderStats stats;
+
+        Camera()
+        {
+            this->pos = V3();
+            this->rot = V3();
+            this->fov = 90;
+            this->focal = 1;
+            this->min = 0;
+            this->max = 100;
+        };
+
+        Camera(V3 pos, V3 rot, float fov, float focal, float min, float max)
+        {
+            this->pos = pos;
+            this->rot = rot;
+            this->fov = fov;
+            this->focal = focal;
+            this->min = min;
+            this->max = max;
+        };
+
+        void moveForward(float distance)
+        {
+            this->pos.x += distance * cos(this->rot.y + M_PI_2);
+            this->pos.z += distance * sin(this->rot.y + M_PI_2);
+        };
+
+        void moveBackward(float distance)
+        {
+            this->pos.x -= distance * cos(this->rot.y + M_PI_2);
+            this->pos.z -= distance * sin(this->rot.y + M_PI_2);
+        };
+
+        void moveLeft(float distance)
+        {
+            this->pos.x -= distance * cos(this->rot.y);
+            this->pos.z -= distance * sin(this->rot.y);
+        };
+
+        void moveRight(float distance)
+        {
+            this->pos.x += distance * cos(this->rot.y);
+            this->pos.z += distance * sin(this->rot.y);
+        };
+
+        void moveUp(float distance)
+        {
+            this->pos.y += distance;
+        };
+
+        void moveDown(float distance)
+        {
+            this->pos.y -= distance;
+        };
+
+        void log(std::string message)
+        {
+            if(this->renderProcessLogs){
+                std::cout << message << std::endl;
+            };
+        };
+
+        float elapsed(std::chrono::steady_clock::time_point &since)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            float ms = 1000 * std::chrono::duration<float>(now - since).count();
+            since = now;
+            return ms;
+        };
+
+        Frame render(int canvasWidth, int canvasHeight, Scene &scene, RenderConfig config = RenderConfig())
+        {
+            std::chrono::steady_clock::time_point worldStart = std::chrono::steady_clock::now();
+            WorldScene world = WorldScene(scene, config.jobs);
+            float worldTime = this->elapsed(worldStart);
+            this->log("World Transform Completed");
+
+            Frame frame = this->render(canvasWidth, canvasHeight, world, config);
+            this->stats.transformTime += worldTime;
+            this->stats.totalTime += worldTime;
+
+            return frame;
+        };
+
+        // inverse16 depth encodes against the near clip plane, without one everything nearer than the
+        // encoding's near plane would saturate and draw in submission order
+        void checkConfig(RenderConfig &config)
+        {
+            if(config.depthFormat == DEPTH_INVERSE_16 && this->min <= 0){
+                throw std::invalid_argument("inverse16 depth needs a camera with min > 0");
+            };
+        };
+
+        // renders against a world transform shared with other views, world is only read
+        Frame render(int canvasWidth, int canvasHeight, WorldScene &world, RenderConfig config = RenderConfig())
+        {
+            this->log("Started Render");
+            this->checkConfig(config);
+
+            this->stats = RenderStats();
+            std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point stageStart = renderStart;
+
+            Transform cameraTransform = Transform(-this->pos, V3(1, 1, 1), this->rot);
+            int renderWidth = config.renderScale < 1 ? fmax(round(config.renderScale * canvasWidth), 1) : canvasWidth;
+            int renderHeight = config.renderScale < 1 ? fmax(round(config.renderScale * canvasHeight), 1) : canvasHeight;
+            int supersample = config.supersample;
+            int bufferWidth = supersample * renderWidth;
+            int bufferHeight = supersample * renderHeight;
+            float fovCoefficient = 0.5 * bufferWidth / (this->focal * tan(this->fov * M_PI / 360));
+
+            this->log("Precomp Completed");
+            
+            bool inverseDepth = config.depthFormat != DEPTH_VIEW_Z;
+            FrameBuffer buffer = FrameBuffer(bufferWidth, bufferHeight, config.depthFormat, this->min, this->max + 1);
+
+            this->stats.bufferTime = this->elapsed(stageStart);
+            this->log("Init Buffer Completed");
+
+            // objects transform independently, each into its own list so the concatenated order stays deterministic
+            std::vector<std::vector<Primitive>> objectPrimitives(world.objects.size());
+            std::function<void(int, int)> transformObjects = [&](int begin, int end){
+                for(int i = begin;i<end;i++)
+                {
+                    std::vector<Primitive> transformed = world.objects[i].transformGeometry(cameraTransform, false).primitives;
+                    objectPrimitives[i].reserve(transformed.size());
+                    for(int j = 0;j<transformed.size();j++)
+                    {
+                        if(transformed[j].p1.z > this->min && transformed[j].p2.z > this->min && transformed[j].p3.z > this->min && transformed[j].p1.z < this->max && transformed[j].p2.z < this->max && transformed[j].p3.z < this->max){
+                            objectPrimitives[i].push_back(transformed[j]);
+
+                            // TODO: troubleshoot culling inaccuracy
+                            // if(!primitive.cullable){
+                            //     primitives.push_back(primitive);
+                            // } else if((primitive.p2.x - primitive.p1.x) * (primitive.p3.y - primitive.p1.y) - (primitive.p2.y - primitive.p1.y) * (primitive.p3.x - primitive.p1.x) < 0) {
+                            //     primitives.push_back(primitive);
+                            // }
+                        };
+                    };
+                };
+            };
+            if(config.jobs){
+                config.jobs->parallelFor(0, world.objects.size(), 16, transformObjects);
+            } else {
+                transformObjects(0, world.objects.size());
+            };
+
+            int primitiveCount = 0;
+            for(int i = 0;i<world.objects.size();i++)
+            {
+                this->stats.trianglesIn += world.objects[i].primitives.size();
+                primitiveCount += objectPrimitives[i].size();
+            };
+            std::vector<Primitive> primitives;
+            primitives.reserve(primitiveCount);
+            // one past the last primitive of each object, to find the palette a primitive's material indexes
+            std::vector<int> objectEnds;
+            objectEnds.reserve(world.objects.size());
+            for(int i = 0;i<objectPrimitives.size();i++)
+            {
+                primitives.insert(primitives.end(), objectPrimitives[i].begin(), objectPrimitives[i].end());
+                objectEnds.push_back(primitives.size());
+            };
+
+            this->stats.trianglesRastered = primitives.size();
+            this->stats.transformTime = this->elapsed(stageStart);
+            this->log("Transform Completed");
+
+            int object = 0;
+            for(int i = 0;i<primitives.size();i++)
+            {
+                while(objectEnds[object] <= i)
+                {
+                    object++;
+                };
+                uint32_t color = world.palettes[object][primitives[i].material];
+
+                primitives[i].p1.x *= fovCoefficient / primitives[i].p1.z;
+                primitives[i].p1.y *= fovCoefficient / primitives[i].p1.z;
+                primitives[i].p2.x *= fovCoefficient / primitives[i].p2.z;
+                primitives[i].p2.y *= fovCoefficient / primitives[i].p2.z;
+                primitives[i].p3.x *= fovCoefficient / primitives[i].p3.z;
+                primitives[i].p3.y *= fovCoefficient / primitives[i].p3.z;
+
+                primitives[i].p1.x += 0.5 * bufferWidth;
+                primitives[i].p1.y = 0.5 * bufferHeight - primitives[i].p1.y;
+                primitives[i].p2.x += 0.5 * bufferWidth;
+                primitives[i].p2.y = 0.5 * bufferHeight - primitives[i].p2.y;
+                primitives[i].p3.x += 0.5 * bufferWidth;
+                primitives[i].p3.y = 0.5 * bufferHeight - primitives[i].p3.y;
+
+                // 1 / z is affine in screen space, so one plane gives exact depth at any sample and steps incrementally along x
+                V3 depthPlane = V3();
+                if(inverseDepth){
+                    V3 p1 = primitives[i].p1;
+                    V3 p2 = primitives[i].p2;
+                    V3 p3 = primitives[i].p3;
+                    float det = (p2.x - p1.x) * (p3.y - p1.y) - (p3.x - p1.x) * (p2.y - p1.y);
+                    if(det == 0){
+                        continue;
+                    };
+                    float d2 = 1 / p2.z - 1 / p1.z;
+                    float d3 = 1 / p3.z - 1 / p1.z;
+                    depthPlane.x = (d2 * (p3.y - p1.y) - d3 * (p2.y - p1.y)) / det;
+                    depthPlane.y = (d3 * (p2.x - p1.x) - d2 * (p3.x - p1.x)) / det;
+                    depthPlane.z = 1 / p1.z - depthPlane.x * p1.x - depthPlane.y * p1.y;
+                };
+
+                // TODO: this is a really confusing way to sort a, b, c
+                std::vector<V3> vertices = { primitives[i].p1, primitives[i].p2, primitives[i].p3 };
+                int index = 0;
+                if(vertices[1].y > vertices[0].y){
+                    index = 1;
+                };
+                if(vertices[2].y > vertices[index].y){
+                    index = 2;
+                }
+                V3 a = vertices[index];
+                vertices.erase(vertices.begin() + index);
+                V3 b, c;
+                if(vertices[0].y > vertices[1].y){
+                    b = vertices[0];
+                    c = vertices[1];
+                } else {
+                    b = vertices[1];
+                    c = vertices[0];
+                };
+
+                bool hasTopFlat = false;
+                std::vector<V3> topFlat;
+                topFlat.reserve(3);
+
+                bool hasBottomFlat = false;
+                std::vector<V3> bottomFlat;
+                bottomFlat.reserve(3);
+
+                if(a.y == b.y){
+                    hasTopFlat = true;
+                    topFlat.push_back(a);
+                    topFlat.push_back(b);
+                    topFlat.push_back(c);
+                } else if(b.y == c.y){
+                    hasBottomFlat = true;
+                    bottomFlat.push_back(a);
+                    bottomFlat.push_back(b);
+                    bottomFlat.push_back(c);
+                } else {
+                    float dx = (c.x - a.x) / (c.y - a.y);
+                    float dz = (c.z - a.z) / (c.y - a.y);
+                    V3 d = V3(a.x - dx * (a.y - b.y), b.y, a.z - dz * (a.y - b.y));
+
+                    hasTopFlat = true;
+                    topFlat.push_back(b);
+                    topFlat.push_back(d);
+                    topFlat.push_back(c);
+
+                    hasBottomFlat = true;
+                    bottomFlat.push_back(a);
+                    bottomFlat.push_back(b);
+                    bottomFlat.push_back(d);
+                };
+                
+                if(hasTopFlat){
+                    V3 a = topFlat[0];
+                    V3 b = topFlat[1];
+                    V3 c = topFlat[2];
+
+                    if(a.y - c.y != 0 && b.y - c.y != 0){
+                        float m1 = (a.x - c.x) / (a.y - c.y);
+                        float m2 = (b.x - c.x) / (b.y - c.y);
+
+                        for(float y = c.y;y<a.y;y++)
+                        {
+                            float x1 = c.x + m1 * (y - c.y);
+                            float x2 = c.x + m2 * (y - c.y);
+                            float minX = x1 < x2 ? x1 : x2;
+                            float maxX = x1 > x2 ? x1 : x2;
+
+                            float inverseZ = depthPlane.x * minX + depthPlane.y * y + depthPlane.z;
+                            for(float x = minX;x<maxX;x++, inverseZ+=depthPlane.x)
+                            {
+                                if(x >= 0 && int(x) < bufferWidth && y >= 0 && int(y) < bufferHeight){
+                                    float z = inverseZ;
+                                    if(!inverseDepth){
+                                        float denominator = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+                                        float numerator1 = (b.y - c.y) * (x - c.x) + (c.x - b.x) * (y - c.y);
+                                        float numerator2 = (c.y - a.y) * (x - c.x) + (a.x - c.x) * (y - c.y);
+
+                                        float w1 = numerator1 / denominator;
+                                        float w2 = numerator2 / denominator;
+                                        float w3 = 1 - w1 - w2;
+
+                                        z = a.z * w1 + b.z * w2 + c.z * w3;
+                                    };
+
+                                    int intX = x;
+                                    int intY = y;
+                                    int index = intY * bufferWidth + intX;
+
+                                    this->stats.samplesTested++;
+                                    if(buffer.depth.test(index, z)){
+                                        this->stats.samplesWritten++;
+                                        // TODO: shade
+                                        buffer.color[index] = color;
+                                    };
+                                };
+                            };
+                        };
+                    }
+                };
+                if(hasBottomFlat){
+                    V3 a = bottomFlat[0];
+                    V3 b = bottomFlat[1];
+                    V3 c = bottomFlat[2];
+
+                    if(b.y - a.y != 0 && c.y - a.y != 0){
+                        float m1 = (b.x - a.x) / (b.y - a.y);
+                        float m2 = (c.x - a.x) / (c.y - a.y);
+
+                        for(float y = c.y;y<a.y;y++)
+                        {
+                            float x1 = a.x + m1 * (y - a.y);
+                            float x2 = a.x + m2 * (y - a.y);
+                            float minX = x1 < x2 ? x1 : x2;
+                            float maxX = x1 > x2 ? x1 : x2;
+                            float inverseZ = depthPlane.x * minX + depthPlane.y * y + depthPlane.z;
+                            for(float x = minX;x<maxX;x++, inverseZ+=depthPlane.x)
+                            {
+                                if(x >= 0 && int(x) < bufferWidth && y >= 0 && int(y) < bufferHeight){
+                                    float z = inverseZ;
+                                    if(!inverseDepth){
+                                        float denominator = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+                                        float numerator1 = (b.y - c.y) * (x - c.x) + (c.x - b.x) * (y - c.y);
+                                        float numerator2 = (c.y - a.y) * (x - c.x) + (a.x - c.x) * (y - c.y);
+
+                                        float w1 = numerator1 / denominator;
+                                        float w2 = numerator2 / denominator;
+                                        float w3 = 1 - w1 - w2;
+
+                                        z = a.z * w1 + b.z * w2 + c.z * w3;
+                                    };
+
+                                    int intX = x;
+                                    int intY = y;
+                                    int index = intY * bufferWidth + intX;
+
+                                    this->stats.samplesTested++;
+                                    if(buffer.depth.test(index, z)){
+                                        this->stats.samplesWritten++;
+                                        // TODO: shade
+                                        buffer.color[index] = color;
+                                    };
+                                };
+                            };
+                        };
+                    };
+                };
+            };
+        
+            this->stats.rasterTime = this->elapsed(stageStart);
+            this->log("Raster Completed");
+
+            Frame frame = Frame(renderWidth, renderHeight, config.resolveDepth);
+
+            double sampleWeight = 1.0 / (supersample * supersample);
+            std::vector<uint32_t> resolved(renderWidth);
+
+            for(int y = 0;y<renderHeight;y++)
+            {
+                if(supersample == 2 && config.simdResolve){
+                    downsampleRow2x2(&buffer.color[2 * y * bufferWidth], &buffer.color[(2 * y + 1) * bufferWidth], renderWidth, resolved.data());
+                } else {
+                    for(int x = 0;x<renderWidth;x++)
+                    {
+                        int r = 0;
+                        int g = 0;
+                        int b = 0;
+                        for(int j = 0;j<supersample;j++)
+                        {
+                            uint32_t* row = &buffer.color[(supersample * y + j) * bufferWidth + supersample * x];
+                            for(int i = 0;i<supersample;i++)
+                            {
+                                r += row[i] & 255;
+                                g += row[i] >> 8 & 255;
+                                b += row[i] >> 16 & 255;
+                            };
+                        };
+                        resolved[x] = int(sampleWeight * r) | int(sampleWeight * g) << 8 | int(sampleWeight * b) << 16 | 255u << 24;
+                    };
+                };
+
+                for(int x = 0;x<renderWidth;x++)
+                {
+                    frame.setPixel(x, y, resolved[x] & 255, resolved[x] >> 8 & 255, resolved[x] >> 16 & 255);
+                };
+                if(config.resolveDepth){
+                    for(int x = 0;x<renderWidth;x++)
+                    {
+                        frame.depth[y * renderWidth + x] = buffer.depth.nearestViewZ(supersample * y * bufferWidth + supersample * x, bufferWidth, supersample);
+                    };
+                };
+            };
+
+            if(renderWidth != canvasWidth || renderHeight != canvasHeight){
+                frame = frame.resized(canvasWidth, canvasHeight);
+            };
+
+            this->stats.resolveTime = this->elapsed(stageStart);
+            this->stats.totalTime = this->elapsed(renderStart);
+            this->log("Render Completed");
+
+            return frame;
+        };
+};
+
+// renders scene from every camera against a single shared WorldScene, with the views running concurrently on
+// config.jobs. onFrame gets the frames on the calling thread in camera order, and at most inFlight views are
+// rendering or waiting to be handed over at once, so a slow consumer holds back rendering instead of piling up frames.
+// each frame is dropped after onFrame returns, so onFrame may move from it
+inline void renderViews(std::vector<Camera> &cameras, int canvasWidth, int canvasHeight, Scene &scene, RenderConfig config, std::function<void(int, Frame&)> onFrame, int inFlight = 0)
+{
+    // fail on the calling thread rather than inside a job
+    for(int i = 0;i<cameras.size();i++)
+    {
+        cameras[i].checkConfig(config);
+    };
+
+    WorldScene world = WorldScene(scene, config.jobs);
+
+    if(!config.jobs){
+        for(int i = 0;i<cameras.size();i++)
+        {
+            Frame frame = cameras[i].render(canvasWidth, canvasHeight, world, config);
+            onFrame(i, frame);
+        };
+        return;
+    };
+
+    inFlight = inFlight > 0 ? inFlight : 2 * config.jobs->size();
+    std::vector<Frame> frames(cameras.size());
+    std::vector<JobHandle> views(cameras.size());
+
+    try {
+        for(int i = 0;i<cameras.size() + inFlight;i++)
+        {
+            // hand over the oldest view before starting another one
+            int done = i - inFlight;
+            if(done >= 0 && done < cameras.size()){
+                config.jobs->wait(views[done]);
+                onFrame(done, frames[done]);
+                frames[done] = Frame();
+                views[done] = nullptr;
+            };
+
+            if(i < cameras.size()){
+                views[i] = config.jobs->submit([&cameras, &frames, &world, config, canvasWidth, canvasHeight, i](){
+                    frames[i] = cameras[i].render(canvasWidth, canvasHeight, world, config);
+                });
+            };
+        };
+    } catch(...) {
+        // views still in flight write into frames and read world, both go away with this frame
+        std::vector<JobHandle> pending;
+        for(int i = 0;i<views.size();i++)
+        {
+            if(views[i]){
+                pending.push_back(views[i]);
+            };
+        };
+        try {
+            config.jobs->wait(pending);
+        } catch(...) {
+        };
+        throw;
+    };
+};
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cmath>
+
+#include "projection.h"
+
+// checks for ResolutionController against a simulated renderer whose cost grows with (renderScale * supersample)^2:
+// the effective resolution has to move in one direction only and then hold, inside the budget unless it hit the floor
+//
+//   ./resolutiontest
+
+class ControllerCase
+{
+    public:
+        // render ms at renderScale 1 and supersample 1
+        float baseCost;
+        // ms per frame spent outside render
+        float overhead;
+        float budget;
+
+        ControllerCase(float baseCost, float overhead, float budget)
+        {
+            this->baseCost = baseCost;
+            this->overhead = overhead;
+            this->budget = budget;
+        };
+
+        std::string name()
+        {
+            std::stringstream name;
+            name << "cost=" << this->baseCost << ",overhead=" << this->overhead << ",budget=" << this->budget;
+            return name.str();
+        };
+
+        // returns an empty string on success, otherwise what went wrong
+        std::string run()
+        {
+            int frames = 120;
+            int settleFrames = 30;
+            ResolutionController controller = ResolutionController(RenderConfig(), this->budget, 0.25, 1, 2);
+
+            std::vector<float> resolution;
+            float renderTime = 0;
+            for(int i = 0;i<frames;i++)
+            {
+                float samples = controller.config.renderScale * controller.config.supersample;
+                resolution.push_back(samples);
+                renderTime = this->baseCost * samples * samples;
+                controller.update(renderTime, renderTime + this->overhead);
+            };
+
+            // one direction only, a reversal is the overshoot this guards against
+            int direction = 0;
+            for(int i = 1;i<frames;i++)
+            {
+                int step = resolution[i] > resolution[i - 1] ? 1 : resolution[i] < resolution[i - 1] ? -1 : 0;
+                if(step != 0 && direction != 0 && step != direction){
+                    return "resolution reversed at frame " + std::to_string(i) + " (" + std::to_string(resolution[i - 1]) + " -> " + std::to_string(resolution[i]) + ")";
+                };
+                direction = step != 0 ? step : direction;
+            };
+
+            for(int i = frames - settleFrames;i<frames;i++)
+            {
+                if(resolution[i] != resolution[frames - 1]){
+                    return "still changing at frame " + std::to_string(i);
+                };
+            };
+
+            bool atFloor = controller.config.renderScale <= controller.minScale && controller.config.supersample == controller.minSupersample;
+            if(renderTime + this->overhead > this->budget && !atFloor){
+                return "settled over budget at " + std::to_string(renderTime + this->overhead) + " ms";
+            };
+            return "";
+        };
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<float> baseCosts = { 1, 4, 10, 25, 60, 400 };
+    std::vector<float> overheads = { 0, 3 };
+    std::vector<float> budgets = { 8.3, 16.6, 33.3 };
+
+    int failures = 0;
+    int cases = 0;
+
+    for(int c = 0;c<baseCosts.size();c++)
+    {
+        for(int o = 0;o<overheads.size();o++)
+        {
+            for(int b = 0;b<budgets.size();b++)
+            {
+                ControllerCase controllerCase = ControllerCase(baseCosts[c], overheads[o], budgets[b]);
+                std::string error = controllerCase.run();
+
+                cases++;
+                if(error != ""){
+                    failures++;
+                };
+                std::cout << (error == "" ? "PASS " : "FAIL ") << controllerCase.name() << (error == "" ? "" : ": " + error) << std::endl;
+            };
+        };
+    };
+
+    std::cout << cases - failures << "/" << cases << " passed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+};
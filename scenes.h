@@ -0,0 +1,191 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "projection.h"
+
+// deterministic generator so scenes are identical across platforms and standard libraries
+class SceneRandom
+{
+    public:
+        uint32_t state;
+
+        SceneRandom(uint32_t seed)
+        {
+            this->state = seed ? seed : 1;
+        };
+
+        uint32_t next()
+        {
+            // xorshift32
+            this->state ^= this->state << 13;
+            this->state ^= this->state >> 17;
+            this->state ^= this->state << 5;
+            return this->state;
+        };
+
+        float range(float min, float max)
+        {
+            return min + (max - min) * (this->next() >> 8) / float(1 << 24);
+        };
+
+        V3 color()
+        {
+            return V3(this->next() % 256, this->next() % 256, this->next() % 256);
+        };
+};
+
+class TestScene
+{
+    public:
+        std::string name;
+        Scene scene;
+        // bounding radius around the origin, used to place cameras
+        float radius;
+        // camera path the scene is meant to be viewed along, "orbit" or "dolly"
+        std::string path;
+
+        TestScene()
+        {
+            this->name = "";
+            this->scene = Scene();
+            this->radius = 1;
+            this->path = "orbit";
+        };
+
+        TestScene(std::string name, Scene scene, float radius, std::string path)
+        {
+            this->name = name;
+            this->scene = scene;
+            this->radius = radius;
+            this->path = path;
+        };
+
+        // count unit cubes on a cubic grid centered at the origin
+        static TestScene CubeGrid(int count)
+        {
+            int side = 1;
+            while(side * side * side < count)
+            {
+                side++;
+            };
+            float spacing = 3;
+            float offset = 0.5 * spacing * (side - 1);
+
+            Scene scene = Scene();
+            scene.objects.reserve(count);
+            for(int i = 0;i<count;i++)
+            {
+                V3 pos = V3(spacing * (i % side) - offset, spacing * (i / side % side) - offset, spacing * (i / (side * side)) - offset);
+                SceneObject cube = SceneObject::ColoredUnitCube(pos);
+                cube.internalTransform.setRot(0.1 * i, 0.2 * i, 0.05 * i);
+                scene.objects.push_back(cube);
+            };
+
+            return TestScene("cubes_" + std::to_string(count), scene, offset * sqrt(3) + 2, "orbit");
+        };
+
+        // count random triangles with edge lengths roughly in [minSize, maxSize] inside a sphere of radius
+        static TestScene TriangleSoup(std::string name, int count, float minSize, float maxSize, float radius, uint32_t seed)
+        {
+            // one material per triangle, so count has to fit the 16 bit material index
+            if(count > UINT16_MAX + 1){
+                throw std::invalid_argument("TriangleSoup supports at most 65536 triangles");
+            };
+            SceneRandom random = SceneRandom(seed);
+
+            std::vector<Primitive> primitives;
+            primitives.reserve(count);
+            std::vector<Material> materials;
+            materials.reserve(count);
+            for(int i = 0;i<count;i++)
+            {
+                V3 center = V3(random.range(-1, 1), random.range(-1, 1), random.range(-1, 1)) * (radius / sqrt(3));
+                float size = random.range(minSize, maxSize);
+                V3 color = random.color();
+                materials.push_back(Material(color, color));
+                primitives.push_back(Primitive(
+                    center + V3(random.range(-1, 1), random.range(-1, 1), random.range(-1, 1)) * size,
+                    center + V3(random.range(-1, 1), random.range(-1, 1), random.range(-1, 1)) * size,
+                    center + V3(random.range(-1, 1), random.range(-1, 1), random.range(-1, 1)) * size,
+                    false,
+                    uint16_t(materials.size() - 1)
+                ));
+            };
+
+            Scene scene = Scene();
+            scene.objects.push_back(SceneObject(primitives, materials, Transform()));
+
+            return TestScene(name, scene, radius + maxSize, "orbit");
+        };
+
+        // layers of large quads facing the camera, submitted back to front so every layer passes the depth test
+        static TestScene OverdrawStack(int layers)
+        {
+            if(layers > UINT16_MAX + 1){
+                throw std::invalid_argument("OverdrawStack supports at most 65536 layers");
+            };
+            SceneRandom random = SceneRandom(layers);
+            float spacing = 0.25;
+            float halfSize = 12;
+
+            std::vector<Primitive> primitives;
+            primitives.reserve(2 * layers);
+            std::vector<Material> materials;
+            materials.reserve(layers);
+            for(int i = layers - 1;i>=0;i--)
+            {
+                float z = spacing * i;
+                V3 color = random.color();
+                materials.push_back(Material(color, color));
+                primitives.push_back(Primitive(V3(-halfSize, -halfSize, z), V3(halfSize, -halfSize, z), V3(halfSize, halfSize, z), false, uint16_t(materials.size() - 1)));
+                primitives.push_back(Primitive(V3(-halfSize, -halfSize, z), V3(halfSize, halfSize, z), V3(-halfSize, halfSize, z), false, uint16_t(materials.size() - 1)));
+            };
+
+            Scene scene = Scene();
+            scene.objects.push_back(SceneObject(primitives, materials, Transform()));
+
+            return TestScene("overdraw_" + std::to_string(layers), scene, spacing * layers, "dolly");
+        };
+
+        // camera for frame index of frameCount along this scene's path
+        Camera camera(int index, int frameCount)
+        {
+            float t = frameCount > 1 ? float(index) / frameCount : 0;
+            Camera camera = Camera();
+            // near plane at the focal distance, every path stays well outside it
+            camera.min = camera.focal;
+            camera.max = fmax(camera.max, 4 * this->radius + 8);
+
+            if(this->path == "dolly"){
+                // straight on from -z, pushing in while swaying a little
+                camera.pos = V3(0, 0, -(2.5 - t) * this->radius - 4);
+                camera.rot = V3(0.05 * sin(2 * M_PI * t), 0.15 * sin(2 * M_PI * t), 0);
+            } else {
+                // full circle around the y axis, looking at the origin
+                float angle = 2 * M_PI * t;
+                float distance = 2 * this->radius + 2;
+                camera.pos = V3(distance * sin(angle), 0, -distance * cos(angle));
+                camera.rot = V3(0, angle, 0);
+            };
+
+            return camera;
+        };
+
+        static std::vector<TestScene> Suite()
+        {
+            return {
+                TestScene::CubeGrid(27),
+                TestScene::CubeGrid(512),
+                TestScene::CubeGrid(4096),
+                TestScene::TriangleSoup("soup_small_20000", 20000, 0.05, 0.3, 10, 1),
+                TestScene::TriangleSoup("soup_large_200", 200, 3, 8, 10, 2),
+                TestScene::TriangleSoup("soup_mixed_5000", 5000, 0.05, 6, 10, 3),
+                TestScene::OverdrawStack(32)
+            };
+        };
+};
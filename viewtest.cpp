@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <functional>
+
+#include "jobs.h"
+#include "projection.h"
+#include "scenes.h"
+#include "framewriter.h"
+
+// checks for the offline path: renderViews against serial Camera::render, and FrameWriter output and error reporting
+//
+//   ./viewtest [--out viewtest_output]
+
+class ViewTest
+{
+    public:
+        std::string name;
+        std::function<std::string()> run;
+
+        ViewTest(std::string name, std::function<std::string()> run)
+        {
+            this->name = name;
+            this->run = run;
+        };
+};
+
+// every view handed over once, in camera order, matching a serial render of the same camera.
+// threads 0 runs renderViews without a job system
+std::string viewsMatchSerial(int threads, int inFlight)
+{
+    TestScene testScene = TestScene::CubeGrid(512);
+    int frameCount = 9;
+    std::vector<Camera> cameras;
+    for(int i = 0;i<frameCount;i++)
+    {
+        cameras.push_back(testScene.camera(i, frameCount));
+    };
+
+    RenderConfig config = RenderConfig();
+    config.resolveDepth = true;
+    std::vector<Frame> serial;
+    for(int i = 0;i<frameCount;i++)
+    {
+        serial.push_back(cameras[i].render(160, 120, testScene.scene, config));
+    };
+
+    JobSystem jobs = JobSystem(threads);
+    config.jobs = threads > 0 ? &jobs : nullptr;
+    int next = 0;
+    std::string error = "";
+    renderViews(cameras, 160, 120, testScene.scene, config, [&](int index, Frame &frame){
+        if(error != ""){
+            return;
+        };
+        if(index != next){
+            error = "got view " + std::to_string(index) + " when " + std::to_string(next) + " was due";
+        } else if(frame.rgb != serial[index].rgb || frame.depth != serial[index].depth){
+            error = "view " + std::to_string(index) + " differs from its serial render";
+        };
+        next++;
+    }, inFlight);
+
+    if(error == "" && next != frameCount){
+        error = "got " + std::to_string(next) + " of " + std::to_string(frameCount) + " views";
+    };
+    return error;
+};
+
+std::string readFile(std::string path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+};
+
+// a black and a white frame come out as full range luma with a header that says so
+std::string y4mFullRange(std::string outPath)
+{
+    int width = 6;
+    int height = 4;
+    Frame black = Frame(width, height);
+    Frame white = Frame(width, height);
+    for(int i = 0;i<white.rgb.size();i++)
+    {
+        white.rgb[i] = 255;
+    };
+
+    std::string path = outPath + "/range.y4m";
+    FrameWriter writer = FrameWriter(path, FRAME_Y4M, 30, 1);
+    writer.push(std::move(black));
+    writer.push(std::move(white));
+    writer.close();
+
+    std::string contents = readFile(path);
+    std::string header = contents.substr(0, contents.find('\n'));
+    if(header.find("XCOLORRANGE=FULL") == std::string::npos){
+        return "header has no full range tag: " + header;
+    };
+
+    int frameSize = width * height * 3 / 2;
+    size_t first = contents.find("FRAME\n") + 6;
+    size_t second = contents.find("FRAME\n", first) + 6;
+    if(contents.size() != second + frameSize){
+        return "expected 2 frames of " + std::to_string(frameSize) + " bytes";
+    };
+    if((unsigned char) contents[first] != 0 || (unsigned char) contents[second] != 255){
+        return "luma of black and white is " + std::to_string((unsigned char) contents[first]) + " and " + std::to_string((unsigned char) contents[second]) + ", not 0 and 255";
+    };
+    return "";
+};
+
+// a write that fails on the writer thread has to come out of close
+std::string closeThrows(std::string outPath)
+{
+    // a directory where the second frame's file should go
+    std::string path = outPath + "/unwritable";
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path + "/frame_00001.ppm");
+
+    FrameWriter writer = FrameWriter(path, FRAME_PPM_SEQUENCE, 30, 1);
+    for(int i = 0;i<3;i++)
+    {
+        writer.push(Frame(4, 4));
+    };
+    try {
+        writer.close();
+    } catch(std::runtime_error &e) {
+        if(writer.framesWritten() != 1){
+            return "threw after " + std::to_string(writer.framesWritten()) + " frames instead of 1";
+        };
+        return "";
+    };
+    return "close did not throw";
+};
+
+int main(int argc, char* argv[])
+{
+    std::string outPath = "viewtest_output";
+
+    try {
+        for(int i = 1;i<argc;i++)
+        {
+            std::string arg = argv[i];
+            if(i + 1 >= argc){
+                throw std::invalid_argument("Missing value for " + arg);
+            };
+            std::string value = argv[++i];
+
+            if(arg == "--out"){
+                outPath = value;
+            } else {
+                throw std::invalid_argument("Unknown argument " + arg);
+            };
+        };
+    } catch(std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    };
+
+    std::filesystem::create_directories(outPath);
+
+    std::vector<ViewTest> tests = {
+        ViewTest("views_without_jobs", [](){ return viewsMatchSerial(0, 0); }),
+        ViewTest("views_threads=1", [](){ return viewsMatchSerial(1, 0); }),
+        ViewTest("views_threads=4_inflight=1", [](){ return viewsMatchSerial(4, 1); }),
+        ViewTest("views_threads=4_inflight=2", [](){ return viewsMatchSerial(4, 2); }),
+        ViewTest("views_threads=8_inflight=3", [](){ return viewsMatchSerial(8, 3); }),
+        ViewTest("y4m_full_range", [outPath](){ return y4mFullRange(outPath); }),
+        ViewTest("close_throws", [outPath](){ return closeThrows(outPath); })
+    };
+
+    int failures = 0;
+    for(int i = 0;i<tests.size();i++)
+    {
+        std::string error;
+        try {
+            error = tests[i].run();
+        } catch(std::exception &e) {
+            error = std::string("threw ") + e.what();
+        };
+
+        if(error != ""){
+            failures++;
+        };
+        std::cout << (error == "" ? "PASS " : "FAIL ") << tests[i].name << (error == "" ? "" : ": " + error) << std::endl;
+    };
+
+    std::cout << tests.size() - failures << "/" << tests.size() << " passed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+};